@@ -0,0 +1,100 @@
+/**
+ *  \file       Checksum.h
+ *  \brief      Specification of the selectable checksum engines.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  A protected block stores the ChecksumAlg it was sealed with next to
+ *  its checksum, so that it can be verified without knowing the engine
+ *  its writer was configured with. The values of ChecksumAlg are part of
+ *  the stored images, so they must never be renumbered.
+ *
+ *  CHECKSUM_CRC32      CRC-32/IEEE, the same one as Crc32_calc() with the
+ *                      0xffffffff init value.
+ *  CHECKSUM_CRC32C     CRC-32C (Castagnoli). On x86-64 hosts with SSE4.2
+ *                      Checksum_init() selects the crc32 instruction,
+ *                      otherwise it is table-driven.
+ *  CHECKSUM_FLETCHER32 Fletcher-32 over little-endian 16-bit words, the
+ *                      last odd byte is padded with zero. It is the
+ *                      cheapest one without hardware support.
+ *  CHECKSUM_XXHASH32   xxHash32 with seed 0. It is not a CRC, so it does
+ *                      not guarantee the detection of burst errors, but
+ *                      it is fast on any 32-bit CPU with a multiplier.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __CHECKSUM_H__
+#define __CHECKSUM_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Crc32.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(CHECKSUM_NO_SSE42)
+#define CHECKSUM_SSE42              1
+#else
+#define CHECKSUM_SSE42              0
+#endif
+
+#define CHECKSUM_ALG_VALID(alg) \
+    (((alg) >= CHECKSUM_CRC32) && ((alg) <= CHECKSUM_XXHASH32))
+
+/**
+ *  Calculates the checksum of a block whose length is known at compile
+ *  time. The CRC-32 engine goes through the fixed-length kernels of
+ *  CRC32_CALC_FIXED(), the other ones through Checksum_calc().
+ */
+#define CHECKSUM_CALC_FIXED(alg, buf, len) \
+    (((alg) == CHECKSUM_CRC32) ? \
+        CRC32_CALC_FIXED((buf), (len), 0xffffffff) : \
+        Checksum_calc((alg), (buf), (len)))
+
+/* -------------------------------- Constants ------------------------------ */
+typedef enum ChecksumAlg ChecksumAlg;
+enum ChecksumAlg
+{
+    CHECKSUM_CRC32 = 1,
+    CHECKSUM_CRC32C = 2,
+    CHECKSUM_FLETCHER32 = 3,
+    CHECKSUM_XXHASH32 = 4
+};
+
+/* ------------------------------- Data types ------------------------------ */
+typedef uint32_t Checksum;
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+void Checksum_init(void);
+Checksum Checksum_calc(ChecksumAlg alg, const uint8_t *buf, size_t len);
+Checksum Checksum_crc32(const uint8_t *buf, size_t len);
+Checksum Checksum_crc32c(const uint8_t *buf, size_t len);
+Checksum Checksum_fletcher32(const uint8_t *buf, size_t len);
+Checksum Checksum_xxHash32(const uint8_t *buf, size_t len);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,242 @@
+/**
+ *  \file       Checksum.c
+ *  \brief      Implementation of the selectable checksum engines.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The CRC-32C table is generated by Crc32_ct.h, as the CRC-32 one of
+ *  Crc32_sw.c, but from the Castagnoli polynomial.
+ *
+ *  xxHash32 follows the reference implementation of Yann Collet,
+ *  https://github.com/Cyan4973/xxHash.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "Checksum.h"
+
+#define CRC32_POLYNOMIAL        0x1EDC6F41
+#include "Crc32_ct.h"
+
+#if CHECKSUM_SSE42 == 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/* ----------------------------- Local macros ------------------------------ */
+#define SSE42_TARGET            __attribute__((target("sse4.2")))
+
+#define LOAD16(p)               ((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8))
+#define LOAD32(p)               ((uint32_t)(p)[0] | \
+                                 ((uint32_t)(p)[1] << 8) | \
+                                 ((uint32_t)(p)[2] << 16) | \
+                                 ((uint32_t)(p)[3] << 24))
+#define ROTL32(x, r)            (((x) << (r)) | ((x) >> (32 - (r))))
+
+/*
+ * Number of words which can be summed before c1 overflows 32 bits,
+ * starting from c0 and c1 less than 65535
+ */
+#define FLETCHER_MAX_WORDS      359
+
+#define XXH_PRIME1              0x9E3779B1u
+#define XXH_PRIME2              0x85EBCA77u
+#define XXH_PRIME3              0xC2B2AE3Du
+#define XXH_PRIME4              0x27D4EB2Fu
+#define XXH_PRIME5              0x165667B1u
+
+/* ------------------------------- Constants ------------------------------- */
+static const Checksum crc32cTable[] =
+{
+    CRC32_CT_TABLE(0)
+};
+
+/* ---------------------------- Local data types --------------------------- */
+typedef Checksum (*ChecksumEngine)(const uint8_t *buf, size_t len);
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+/* ----------------------- Local function prototypes ----------------------- */
+static Checksum crc32cBytes(const uint8_t *buf, size_t len);
+
+#if CHECKSUM_SSE42 == 1
+static ChecksumEngine crc32c = crc32cBytes;
+#else
+#define crc32c                  crc32cBytes
+#endif
+
+static const ChecksumEngine engines[] =
+{
+    (ChecksumEngine)0,
+    Checksum_crc32, Checksum_crc32c, Checksum_fletcher32, Checksum_xxHash32
+};
+
+/* ---------------------------- Local functions ---------------------------- */
+static Checksum
+crc32cBytes(const uint8_t *buf, size_t len)
+{
+    Checksum remainder = CRC32_INITIAL_REMAINDER;
+
+    for (; len != 0; --len, ++buf)
+    {
+        remainder = crc32cTable[(remainder ^ *buf) & 0xff] ^
+                    (remainder >> 8);
+    }
+    return remainder ^ CRC32_FINAL_XOR_VALUE;
+}
+
+#if CHECKSUM_SSE42 == 1
+static bool
+sse42Available(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return false;
+    }
+    return (ecx & bit_SSE4_2) != 0;
+}
+
+static SSE42_TARGET Checksum
+crc32cSse42(const uint8_t *buf, size_t len)
+{
+    uint64_t remainder = CRC32_INITIAL_REMAINDER;
+    uint64_t word;
+
+    for (; len >= 8; len -= 8, buf += 8)
+    {
+        memcpy(&word, buf, sizeof(word));
+        remainder = _mm_crc32_u64(remainder, word);
+    }
+    for (; len != 0; --len, ++buf)
+    {
+        remainder = _mm_crc32_u8((uint32_t)remainder, *buf);
+    }
+    return (Checksum)remainder ^ CRC32_FINAL_XOR_VALUE;
+}
+#endif
+
+static uint32_t
+xxhRound(uint32_t acc, uint32_t input)
+{
+    acc += input * XXH_PRIME2;
+    acc = ROTL32(acc, 13);
+    return acc * XXH_PRIME1;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+Checksum_init(void)
+{
+    Crc32_init();
+#if CHECKSUM_SSE42 == 1
+    crc32c = sse42Available() ? crc32cSse42 : crc32cBytes;
+#endif
+}
+
+/**
+ *  Returns 0 when alg is not a valid ChecksumAlg, so the callers check
+ *  the tag of a block by means of CHECKSUM_ALG_VALID() before trusting it.
+ */
+Checksum
+Checksum_calc(ChecksumAlg alg, const uint8_t *buf, size_t len)
+{
+    return CHECKSUM_ALG_VALID(alg) ? engines[alg](buf, len) : 0;
+}
+
+Checksum
+Checksum_crc32(const uint8_t *buf, size_t len)
+{
+    return Crc32_calc(buf, len, 0xffffffff);
+}
+
+Checksum
+Checksum_crc32c(const uint8_t *buf, size_t len)
+{
+    return crc32c(buf, len);
+}
+
+Checksum
+Checksum_fletcher32(const uint8_t *buf, size_t len)
+{
+    uint32_t c0 = 0, c1 = 0;
+    size_t nWords, block, i;
+
+    for (nWords = len / 2; nWords != 0; nWords -= block)
+    {
+        block = (nWords < FLETCHER_MAX_WORDS) ? nWords : FLETCHER_MAX_WORDS;
+        for (i = 0; i < block; ++i, buf += 2)
+        {
+            c0 += LOAD16(buf);
+            c1 += c0;
+        }
+        c0 %= 65535;
+        c1 %= 65535;
+    }
+    if ((len & 0x01) != 0)
+    {
+        c0 = (c0 + *buf) % 65535;
+        c1 = (c1 + c0) % 65535;
+    }
+    return (c1 << 16) | c0;
+}
+
+Checksum
+Checksum_xxHash32(const uint8_t *buf, size_t len)
+{
+    const uint8_t *end = buf + len;
+    uint32_t v1, v2, v3, v4, hash;
+
+    if (len >= 16)
+    {
+        v1 = XXH_PRIME1 + XXH_PRIME2;
+        v2 = XXH_PRIME2;
+        v3 = 0;
+        v4 = 0 - XXH_PRIME1;
+        for (; (end - buf) >= 16; buf += 16)
+        {
+            v1 = xxhRound(v1, LOAD32(buf));
+            v2 = xxhRound(v2, LOAD32(buf + 4));
+            v3 = xxhRound(v3, LOAD32(buf + 8));
+            v4 = xxhRound(v4, LOAD32(buf + 12));
+        }
+        hash = ROTL32(v1, 1) + ROTL32(v2, 7) + ROTL32(v3, 12) +
+               ROTL32(v4, 18);
+    }
+    else
+    {
+        hash = XXH_PRIME5;
+    }
+
+    hash += (uint32_t)len;
+    for (; (end - buf) >= 4; buf += 4)
+    {
+        hash += LOAD32(buf) * XXH_PRIME3;
+        hash = ROTL32(hash, 17) * XXH_PRIME4;
+    }
+    for (; buf != end; ++buf)
+    {
+        hash += *buf * XXH_PRIME5;
+        hash = ROTL32(hash, 11) * XXH_PRIME1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= XXH_PRIME2;
+    hash ^= hash >> 13;
+    hash *= XXH_PRIME3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/* ------------------------------ End of file ------------------------------ */
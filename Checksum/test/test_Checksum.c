@@ -0,0 +1,179 @@
+/**
+ *  \file       test_Checksum.c
+ *  \brief      Unit test for the checksum engines
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci  lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "Checksum.h"
+
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define POLYNOMIAL_CRC32C   0x82f63b78      /* reflected */
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint8_t message[4096 + 8];
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static Checksum
+refCrc32c(const uint8_t *buf, size_t len)
+{
+    Checksum remainder = 0xffffffff;
+    int bit;
+
+    for (; len != 0; --len, ++buf)
+    {
+        remainder ^= *buf;
+        for (bit = 0; bit < 8; ++bit)
+        {
+            remainder = (remainder & 0x01) ?
+                        (remainder >> 1) ^ POLYNOMIAL_CRC32C :
+                        (remainder >> 1);
+        }
+    }
+    return remainder ^ 0xffffffff;
+}
+
+/*
+ *  Fletcher-32 reducing both sums on every word, so that it can not
+ *  overflow.
+ */
+static Checksum
+refFletcher32(const uint8_t *buf, size_t len)
+{
+    uint32_t c0 = 0, c1 = 0;
+
+    for (; len >= 2; len -= 2, buf += 2)
+    {
+        c0 = (c0 + (buf[0] | (buf[1] << 8))) % 65535;
+        c1 = (c1 + c0) % 65535;
+    }
+    if (len != 0)
+    {
+        c0 = (c0 + buf[0]) % 65535;
+        c1 = (c1 + c0) % 65535;
+    }
+    return (c1 << 16) | c0;
+}
+
+static void
+fillMessage(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(message); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        message[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    Checksum_init();
+}
+
+void
+tearDown(void)
+{
+}
+
+void
+test_CalculateKnownValues(void)
+{
+    const uint8_t check[] = "123456789";
+    const uint8_t text[] = "Nobody inspects the spammish repetition";
+
+    TEST_ASSERT_EQUAL_HEX(0xcbf43926, Checksum_crc32(check, 9));
+    TEST_ASSERT_EQUAL_HEX(0xe3069283, Checksum_crc32c(check, 9));
+    TEST_ASSERT_EQUAL_HEX(0xf04fc729,
+                          Checksum_fletcher32((const uint8_t *)"abcde", 5));
+    TEST_ASSERT_EQUAL_HEX(0x56502d2a,
+                          Checksum_fletcher32((const uint8_t *)"abcdef", 6));
+    TEST_ASSERT_EQUAL_HEX(0xebe19591,
+                          Checksum_fletcher32((const uint8_t *)"abcdefgh",
+                                              8));
+    TEST_ASSERT_EQUAL_HEX(0x02cc5d05, Checksum_xxHash32(check, 0));
+    TEST_ASSERT_EQUAL_HEX(0x32d153ff,
+                          Checksum_xxHash32((const uint8_t *)"abc", 3));
+    TEST_ASSERT_EQUAL_HEX(0xe2293b2f,
+                          Checksum_xxHash32(text, sizeof(text) - 1));
+}
+
+void
+test_MatchCrc32cReferenceForEveryLengthAndAlignment(void)
+{
+    size_t len, offset;
+
+    fillMessage(0xc0de);
+    for (offset = 0; offset < 8; ++offset)
+    {
+        for (len = 0; len <= 80; ++len)
+        {
+            TEST_ASSERT_EQUAL_HEX(refCrc32c(message + offset, len),
+                                  Checksum_crc32c(message + offset, len));
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX(refCrc32c(message, sizeof(message)),
+                          Checksum_crc32c(message, sizeof(message)));
+}
+
+void
+test_ReduceFletcher32SumsBeforeTheyOverflow(void)
+{
+    memset(message, 0xff, sizeof(message));
+    TEST_ASSERT_EQUAL_HEX(refFletcher32(message, sizeof(message)),
+                          Checksum_fletcher32(message, sizeof(message)));
+    fillMessage(0xf1e7);
+    TEST_ASSERT_EQUAL_HEX(refFletcher32(message, sizeof(message) - 1),
+                          Checksum_fletcher32(message, sizeof(message) - 1));
+}
+
+void
+test_DispatchByAlgorithmTag(void)
+{
+    fillMessage(0xa1);
+    TEST_ASSERT_EQUAL_HEX(Checksum_crc32(message, 100),
+                          Checksum_calc(CHECKSUM_CRC32, message, 100));
+    TEST_ASSERT_EQUAL_HEX(Checksum_crc32c(message, 100),
+                          Checksum_calc(CHECKSUM_CRC32C, message, 100));
+    TEST_ASSERT_EQUAL_HEX(Checksum_fletcher32(message, 100),
+                          Checksum_calc(CHECKSUM_FLETCHER32, message, 100));
+    TEST_ASSERT_EQUAL_HEX(Checksum_xxHash32(message, 100),
+                          Checksum_calc(CHECKSUM_XXHASH32, message, 100));
+    TEST_ASSERT_FALSE(CHECKSUM_ALG_VALID(0));
+    TEST_ASSERT_FALSE(CHECKSUM_ALG_VALID(CHECKSUM_XXHASH32 + 1));
+    TEST_ASSERT_EQUAL_HEX(0, Checksum_calc((ChecksumAlg)0, message, 100));
+}
+
+void
+test_CalculateFixedLengthBlocks(void)
+{
+    fillMessage(0xb10c);
+    TEST_ASSERT_EQUAL_HEX(Checksum_crc32(message, 24),
+                          CHECKSUM_CALC_FIXED(CHECKSUM_CRC32, message, 24));
+    TEST_ASSERT_EQUAL_HEX(Checksum_xxHash32(message, 24),
+                          CHECKSUM_CALC_FIXED(CHECKSUM_XXHASH32, message,
+                                              24));
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -28,13 +28,28 @@
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  The stored block carries the tag of the checksum engine it was sealed 
+ *  with, so a block is verified with its own engine. The engine used to 
+ *  seal new blocks is CONFIG_CHECKSUM_ALG, unless it is changed at 
+ *  run-time by means of Config_setChecksum().
+ */
+
 /* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
 #include "Config.h"
 #include "ConfigDft.h"
 #include "NVMem.h"
-#include "Crc32.h"
+#include "Checksum.h"
 
 /* ----------------------------- Local macros ------------------------------ */
+#ifndef CONFIG_CHECKSUM_ALG
+#define CONFIG_CHECKSUM_ALG     CHECKSUM_CRC32
+#endif
+
+/* The checksum covers the data and the tag, but not the checksum itself */
+#define CONFIG_SUM_LEN          offsetof(Config, sum)
+
 /* ------------------------------- Constants ------------------------------- */
 /* ---------------------------- Local data types --------------------------- */
 typedef struct ConfigData ConfigData;
@@ -48,33 +63,58 @@ typedef struct Config Config;
 struct Config
 {
     ConfigData data;
-    Crc32 crc;
+    uint32_t alg;       /* ChecksumAlg, 32-bit wide to leave no padding */
+    Checksum sum;
 };
 
+_Static_assert(sizeof(Config) <= NVMEM_PART_SIZE(CONFIG), 
+               "Config does not fit in its NVMem region");
+
 /* ---------------------------- Global variables --------------------------- */
 /* ---------------------------- Local variables ---------------------------- */
 static ConfigErrorHandler errorHandler = (ConfigErrorHandler)0;
 static Config config;
+static ChecksumAlg checksumAlg = CONFIG_CHECKSUM_ALG;
 static const Config configDefault =
 {
     {
         CONFIG_OPTA_DFT, 
         CONFIG_OPTB_DFT
-    }, 0
+    }, CONFIG_CHECKSUM_ALG, 0
 };
 
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+static bool
+checkData(const Config *data)
+{
+    Checksum sum;
+
+    if (!CHECKSUM_ALG_VALID(data->alg))
+    {
+        return false;
+    }
+    sum = CHECKSUM_CALC_FIXED((ChecksumAlg)data->alg, (const uint8_t *)data, 
+                              CONFIG_SUM_LEN);
+    return (sum == data->sum) ? true : false;
+}
+
+static void
+seal(Config *data)
+{
+    data->alg = checksumAlg;
+    data->sum = CHECKSUM_CALC_FIXED(checksumAlg, (const uint8_t *)data, 
+                                    CONFIG_SUM_LEN);
+}
+
 static bool
 checkDataFromNVMem(Config *data)
 {
     bool res = false;
     Config cfg;
-    Crc32 crc;
 
     NVMem_readData(CONFIG_ADDR_BEGIN, sizeof(Config), (uint8_t *)&cfg);
-    crc = Crc32_calc((const uint8_t *)&cfg, sizeof(Config), 0xffffffff);
-    if (crc == cfg.crc)
+    if (checkData(&cfg) == true)
     {
         if (data != (Config *)0)
         {
@@ -85,22 +125,13 @@ checkDataFromNVMem(Config *data)
     return res;
 }
 
-static bool
-checkData(const Config *data)
-{
-    Crc32 crc;
-
-    crc = Crc32_calc((const uint8_t *)data, sizeof(Config), 0xffffffff);
-    return (crc == data->crc) ? true : false;
-}
-
 /* ---------------------------- Global functions --------------------------- */
 ConfigErrorCode
 Config_init(void)
 {
     ConfigErrorCode res = NO_ERRORS;
 
-    Crc32_init();
+    Checksum_init();
     if (checkDataFromNVMem(&config) == false)
     {
         res = INIT_DATA;
@@ -109,6 +140,7 @@ Config_init(void)
             errorHandler(res);
         }
         config = configDefault;
+        seal(&config);
         NVMem_storeData(CONFIG_ADDR_BEGIN, sizeof(Config), 
                         (const uint8_t *)&config);
     }
@@ -121,6 +153,19 @@ Config_setErrorHandler(ConfigErrorHandler errHandler)
     errorHandler = errHandler;
 }
 
+bool
+Config_setChecksum(ChecksumAlg alg)
+{
+    bool res = false;
+
+    if (CHECKSUM_ALG_VALID(alg))
+    {
+        checksumAlg = alg;
+        res = true;
+    }
+    return res;
+}
+
 bool
 Config_getOptionA(int *value)
 {
@@ -159,8 +204,7 @@ Config_setOptionA(int value)
     else
     {
         config.data.optionA = value;
-        config.crc = Crc32_calc((const uint8_t *)&config, sizeof(Config), 
-                                0xffffffff);
+        seal(&config);
         NVMem_storeData(CONFIG_ADDR_BEGIN, sizeof(Config), 
                         (const uint8_t *)&config);
         res = true;
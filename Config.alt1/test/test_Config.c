@@ -19,10 +19,12 @@
 
 /* --------------------------------- Notes --------------------------------- */
 /* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
 #include "unity.h"
 #include "Config.h"
 #include "Mock_NVMem.h"
 #include "Mock_Crc32.h"
+#include "Mock_Checksum.h"
 
 /* ----------------------------- Local macros ------------------------------ */
 /* ------------------------------- Constants ------------------------------- */
@@ -42,7 +44,8 @@ typedef struct Config Config;
 struct Config
 {
     ConfigData data;
-    Crc32 crc;
+    uint32_t alg;
+    Checksum sum;
 };
 
 /* ---------------------------- Global variables --------------------------- */
@@ -51,11 +54,56 @@ static Config cfgRead, cfgStore;
 static ConfigErrorCode errCodeCb;
 static const Config configDefault =
 {
-    {64, 1024}, 0
+    {64, 1024}, CHECKSUM_CRC32, 0
 };
 
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+/*
+ *  Config.c calculates its checksums by means of CHECKSUM_CALC_FIXED(), so 
+ *  the CRC-32 ones go through the fixed-length kernel of the size of the 
+ *  block on this host.
+ */
+static void
+expectChecksum(ChecksumAlg alg, Checksum sum)
+{
+    size_t len = offsetof(Config, sum);
+
+    if (alg != CHECKSUM_CRC32)
+    {
+        Checksum_calc_ExpectAndReturn(alg, 0, len, sum);
+        Checksum_calc_IgnoreArg_buf();
+        return;
+    }
+    switch (len)
+    {
+        case 8:
+            Crc32_calc8_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc8_IgnoreArg_buf();
+            break;
+        case 12:
+            Crc32_calc12_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc12_IgnoreArg_buf();
+            break;
+        case 16:
+            Crc32_calc16_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc16_IgnoreArg_buf();
+            break;
+        case 20:
+            Crc32_calc20_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc20_IgnoreArg_buf();
+            break;
+        case 24:
+            Crc32_calc24_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc24_IgnoreArg_buf();
+            break;
+        default:
+            Crc32_calc_ExpectAndReturn(0, len, 0xffffffff, sum);
+            Crc32_calc_IgnoreArg_buf();
+            break;
+    }
+}
+
 static void
 cbNVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to, 
                  int cmock_num_calls)
@@ -73,6 +121,16 @@ cbNVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from,
     }
 }
 
+static void
+cbNVMem_storeSealedData(uint32_t to, uint32_t nBytes, const uint8_t *from, 
+                        int cmock_num_calls)
+{
+    TEST_ASSERT_EQUAL(cfgStore.data.optionA, 
+                      ((Config *)from)->data.optionA);
+    TEST_ASSERT_EQUAL(cfgStore.alg, ((Config *)from)->alg);
+    TEST_ASSERT_EQUAL_HEX(cfgStore.sum, ((Config *)from)->sum);
+}
+
 static void 
 errorHandler(ConfigErrorCode errCode)
 {
@@ -83,6 +141,7 @@ errorHandler(ConfigErrorCode errCode)
 void 
 setUp(void)
 {
+    Config_setChecksum(CHECKSUM_CRC32);
 }
 
 void 
@@ -95,14 +154,15 @@ test_InitWithInvalidData(void)
 {
     ConfigErrorCode res;
 
-    cfgRead.crc = 0xffffffff;
+    cfgRead = configDefault;
+    cfgRead.sum = 0xffffffff;
     cfgStore = configDefault;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, ~cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, ~cfgRead.sum);
+    expectChecksum(CHECKSUM_CRC32, 0xdeadbeef);
     NVMem_storeData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
@@ -116,13 +176,13 @@ test_InitWithValidData(void)
 {
     ConfigErrorCode res;
 
-    cfgRead.crc = 0xdeadbeef;
-    Crc32_init_Expect();
+    cfgRead = configDefault;
+    cfgRead.sum = 0xdeadbeef;
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     res = Config_init();
     TEST_ASSERT_EQUAL(NO_ERRORS, res);
@@ -133,15 +193,16 @@ test_InitAndCallErrorHandler(void)
 {
     ConfigErrorCode res;
 
-    cfgRead.crc = 0xffffffff;
+    cfgRead = configDefault;
+    cfgRead.sum = 0xffffffff;
     cfgStore = configDefault;
     errCodeCb = INIT_DATA;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, ~cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, ~cfgRead.sum);
+    expectChecksum(CHECKSUM_CRC32, 0xdeadbeef);
     NVMem_storeData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
@@ -159,17 +220,15 @@ test_GetOptA(void)
 
     cfgRead = configDefault;
     errCodeCb = INIT_DATA;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     Config_init();
 
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     getRes = Config_getOptionA(&value);
 
@@ -186,18 +245,16 @@ test_TryToGetOptAWithCorruptedData(void)
     value = 1024;
     cfgRead = configDefault;
     errCodeCb = INIT_DATA;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     Config_init();
 
     errCodeCb = CORRUPT_DATA;
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, ~cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, ~cfgRead.sum);
 
     getRes = Config_getOptionA(&value);
 
@@ -212,17 +269,15 @@ test_TryToGetOptAWithAnInvalidArg(void)
 
     cfgRead = configDefault;
     errCodeCb = INIT_DATA;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     res = Config_init();
 
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     res = Config_getOptionA(0);
 
@@ -238,19 +293,16 @@ test_SetOptA(void)
     cfgRead = configDefault;
     cfgStore.data.optionA = value = 2048;
     errCodeCb = INIT_DATA;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     Config_init();
 
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
     NVMem_storeData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
@@ -267,22 +319,92 @@ test_TryToSetOptAWithCorruptedData(void)
 
     cfgRead = configDefault;
     errCodeCb = INIT_DATA;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     Config_init();
 
     errCodeCb = CORRUPT_DATA;
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, ~cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, ~cfgRead.sum);
 
     setRes = Config_setOptionA(2048);
 
     TEST_ASSERT_FALSE(setRes);
 }
 
+void
+test_InitWithDataSealedByAnotherChecksum(void)
+{
+    ConfigErrorCode res;
+
+    cfgRead = configDefault;
+    cfgRead.alg = CHECKSUM_FLETCHER32;
+    cfgRead.sum = 0x12345678;
+    Checksum_init_Expect();
+    NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
+    NVMem_readData_IgnoreArg_to();
+    NVMem_readData_StubWithCallback(cbNVMem_readData);
+    expectChecksum(CHECKSUM_FLETCHER32, cfgRead.sum);
+
+    res = Config_init();
+    TEST_ASSERT_EQUAL(NO_ERRORS, res);
+}
+
+void
+test_InitWithAnUnknownChecksumTag(void)
+{
+    ConfigErrorCode res;
+
+    cfgRead = configDefault;
+    cfgRead.alg = 0xff;
+    cfgStore = configDefault;
+    cfgStore.sum = 0xdeadbeef;
+    errCodeCb = INIT_DATA;
+    Checksum_init_Expect();
+    NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
+    NVMem_readData_IgnoreArg_to();
+    NVMem_readData_StubWithCallback(cbNVMem_readData);
+    expectChecksum(CHECKSUM_CRC32, cfgStore.sum);
+    NVMem_storeData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
+    NVMem_storeData_IgnoreArg_from();
+    NVMem_storeData_StubWithCallback(cbNVMem_storeSealedData);
+
+    res = Config_init();
+    TEST_ASSERT_EQUAL(INIT_DATA, res);
+}
+
+void
+test_SetOptAWithAnotherChecksum(void)
+{
+    bool setRes;
+
+    cfgRead = configDefault;
+    cfgRead.sum = 0xdeadbeef;
+    Checksum_init_Expect();
+    NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
+    NVMem_readData_IgnoreArg_to();
+    NVMem_readData_StubWithCallback(cbNVMem_readData);
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
+
+    Config_init();
+
+    TEST_ASSERT_FALSE(Config_setChecksum((ChecksumAlg)0));
+    TEST_ASSERT_TRUE(Config_setChecksum(CHECKSUM_XXHASH32));
+    cfgStore.data.optionA = 2048;
+    cfgStore.alg = CHECKSUM_XXHASH32;
+    cfgStore.sum = 0x0badcafe;
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
+    expectChecksum(CHECKSUM_XXHASH32, cfgStore.sum);
+    NVMem_storeData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
+    NVMem_storeData_IgnoreArg_from();
+    NVMem_storeData_StubWithCallback(cbNVMem_storeSealedData);
+
+    setRes = Config_setOptionA(2048);
+
+    TEST_ASSERT_TRUE(setRes);
+}
+
 /* ------------------------------ End of file ------------------------------ */
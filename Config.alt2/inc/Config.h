@@ -35,6 +35,8 @@
 /* ----------------------------- Include files ----------------------------- */
 #include <stdint.h>
 #include <stdbool.h>
+#include "Checksum.h"
+#include "NVMem_part.h"
 
 /* ---------------------- External C language linkage ---------------------- */
 #ifdef __cplusplus
@@ -43,7 +45,7 @@ extern "C" {
 
 /* --------------------------------- Macros -------------------------------- */
 /* -------------------------------- Constants ------------------------------ */
-#define CONFIG_ADDR_BEGIN       0
+#define CONFIG_ADDR_BEGIN       NVMEM_PART_ADDR(CONFIG)
 
 typedef enum ConfigErrorCode ConfigErrorCode;
 enum ConfigErrorCode
@@ -60,6 +62,7 @@ typedef void (*ConfigErrorHandler)(ConfigErrorCode errCode);
 /* -------------------------- Function prototypes -------------------------- */
 ConfigErrorCode Config_init(void);
 void Config_setErrorHandler(ConfigErrorHandler errHandler);
+bool Config_setChecksum(ChecksumAlg alg);
 bool Config_getOptionA(int *value);
 bool Config_getOptionB(long *value);
 bool Config_setOptionA(int value);
@@ -19,10 +19,12 @@
 
 /* --------------------------------- Notes --------------------------------- */
 /* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
 #include "unity.h"
 #include "Config.h"
 #include "Mock_NVMem.h"
 #include "Mock_Crc32.h"
+#include "Mock_Checksum.h"
 
 /* ----------------------------- Local macros ------------------------------ */
 /* ------------------------------- Constants ------------------------------- */
@@ -42,7 +44,8 @@ typedef struct Config Config;
 struct Config
 {
     ConfigData data;
-    Crc32 crc;
+    uint32_t alg;
+    Checksum sum;
 };
 
 /* ---------------------------- Global variables --------------------------- */
@@ -51,11 +54,56 @@ static Config cfgRead;
 static ConfigErrorCode errCodeCb;
 static const Config configDefault =
 {
-    {64, 1024}, 0
+    {64, 1024}, CHECKSUM_CRC32, 0
 };
 
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+/*
+ *  Config.c calculates its checksums by means of CHECKSUM_CALC_FIXED(), so 
+ *  the CRC-32 ones go through the fixed-length kernel of the size of the 
+ *  block on this host.
+ */
+static void
+expectChecksum(ChecksumAlg alg, Checksum sum)
+{
+    size_t len = offsetof(Config, sum);
+
+    if (alg != CHECKSUM_CRC32)
+    {
+        Checksum_calc_ExpectAndReturn(alg, 0, len, sum);
+        Checksum_calc_IgnoreArg_buf();
+        return;
+    }
+    switch (len)
+    {
+        case 8:
+            Crc32_calc8_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc8_IgnoreArg_buf();
+            break;
+        case 12:
+            Crc32_calc12_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc12_IgnoreArg_buf();
+            break;
+        case 16:
+            Crc32_calc16_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc16_IgnoreArg_buf();
+            break;
+        case 20:
+            Crc32_calc20_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc20_IgnoreArg_buf();
+            break;
+        case 24:
+            Crc32_calc24_ExpectAndReturn(0, 0xffffffff, sum);
+            Crc32_calc24_IgnoreArg_buf();
+            break;
+        default:
+            Crc32_calc_ExpectAndReturn(0, len, 0xffffffff, sum);
+            Crc32_calc_IgnoreArg_buf();
+            break;
+    }
+}
+
 static void
 cbNVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to, 
                  int cmock_num_calls)
@@ -82,12 +130,11 @@ test_GetOptA(void)
 
     cfgRead = configDefault;
     errCodeCb = INIT_DATA;
-    Crc32_init_Expect();
+    Checksum_init_Expect();
     NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
     NVMem_readData_IgnoreArg_to();
     NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(Config), 0xffffffff, cfgRead.crc);
-    Crc32_calc_IgnoreArg_buf();
+    expectChecksum(CHECKSUM_CRC32, cfgRead.sum);
 
     Config_init();
 
@@ -97,4 +144,22 @@ test_GetOptA(void)
     TEST_ASSERT_EQUAL(64, value);
 }
 
+void
+test_InitWithDataSealedByAnotherChecksum(void)
+{
+    ConfigErrorCode res;
+
+    cfgRead = configDefault;
+    cfgRead.alg = CHECKSUM_CRC32C;
+    cfgRead.sum = 0x12345678;
+    Checksum_init_Expect();
+    NVMem_readData_Expect(CONFIG_ADDR_BEGIN, sizeof(Config), 0);
+    NVMem_readData_IgnoreArg_to();
+    NVMem_readData_StubWithCallback(cbNVMem_readData);
+    expectChecksum(CHECKSUM_CRC32C, cfgRead.sum);
+
+    res = Config_init();
+    TEST_ASSERT_EQUAL(NO_ERRORS, res);
+}
+
 /* ------------------------------ End of file ------------------------------ */
@@ -35,6 +35,7 @@
 /* ----------------------------- Include files ----------------------------- */
 #include <stdint.h>
 #include <stdbool.h>
+#include "NVMem_part.h"
 
 /* ---------------------- External C language linkage ---------------------- */
 #ifdef __cplusplus
@@ -43,8 +44,8 @@ extern "C" {
 
 /* --------------------------------- Macros -------------------------------- */
 /* -------------------------------- Constants ------------------------------ */
-#define CONFIG_MAIN_ADDR        0
-#define CONFIG_BACKUP_ADDR      512
+#define CONFIG_MAIN_ADDR        NVMEM_PART_ADDR(CONFIG_MAIN)
+#define CONFIG_BACKUP_ADDR      NVMEM_PART_ADDR(CONFIG_BACKUP)
 
 typedef enum ConfigErrorCode ConfigErrorCode;
 enum ConfigErrorCode
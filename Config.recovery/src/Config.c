@@ -28,13 +28,38 @@
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  The CRC of configDefault is calculated at compile time, so that the 
+ *  default image is stored in flash ready to be written. This is only 
+ *  done when Crc32_calc() returns the IEEE CRC-32, see CRC32_CT_IEEE, 
+ *  otherwise proc_in_error() calculates it at run time.
+ *
+ *  When both blocks are memory-mapped, their CRCs are checked in place 
+ *  and only the one used afterwards is copied into RAM. Otherwise both 
+ *  blocks are read by a single NVMem_readv() call. Either way, their 
+ *  CRCs are calculated at once by Crc32_calcMulti().
+ *
+ *  Both copies are never written at once. The main one is stored and 
+ *  flushed before the backup one is stored, so a reset during a store 
+ *  corrupts one copy at most, and the other one recovers it. A copy 
+ *  repaired by Config_init() is flushed as well.
+ */
+
 /* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
 #include "Config.h"
 #include "ConfigDft.h"
 #include "NVMem.h"
 #include "Crc32.h"
+#include "Crc32_ct.h"
 
 /* ----------------------------- Local macros ------------------------------ */
+#define CONFIG_DFT_BYTE(k) \
+    (CRC32_CT_FIELD_BYTE(k, CONFIG_OPTA_DFT, int, \
+                         offsetof(ConfigData, optionA)) | \
+     CRC32_CT_FIELD_BYTE(k, CONFIG_OPTB_DFT, long, \
+                         offsetof(ConfigData, optionB)))
+
 /* ------------------------------- Constants ------------------------------- */
 /* ---------------------------- Local data types --------------------------- */
 typedef ConfigErrorCode (*RecProc)(void);
@@ -53,6 +78,11 @@ struct Config
     Crc32 crc;
 };
 
+_Static_assert(sizeof(Config) <= NVMEM_PART_SIZE(CONFIG_MAIN), 
+               "Config does not fit in its NVMem region");
+_Static_assert(sizeof(Config) <= NVMEM_PART_SIZE(CONFIG_BACKUP), 
+               "Config does not fit in its NVMem region");
+
 typedef struct ConfigInitBlock ConfigInitBlock;
 struct ConfigInitBlock
 {
@@ -65,12 +95,21 @@ struct ConfigInitBlock
 static ConfigErrorHandler errorHandler = (ConfigErrorHandler)0;
 static ConfigInitBlock main, backup;
 static Config block, backupBlock;
+#if CRC32_CT_IEEE == 1
+CRC32_CT_DEFINE(configDftCrc, sizeof(ConfigData), 0xffffffff, 
+                CONFIG_DFT_BYTE);
+#endif
 static const Config configDefault =
 {
     {
         CONFIG_OPTA_DFT, 
         CONFIG_OPTB_DFT
-    }, 0
+    }, 
+#if CRC32_CT_IEEE == 1
+    CRC32_CT_VALUE(configDftCrc)
+#else
+    0
+#endif
 };
 
 /*
@@ -105,16 +144,41 @@ static const RecProc recovery[] =
 
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+static void
+storeBoth(const Config *from)
+{
+    NVMem_storeData(CONFIG_MAIN_ADDR, sizeof(Config), 
+                    (const uint8_t *)from);
+    NVMem_flush();
+    NVMem_storeData(CONFIG_BACKUP_ADDR, sizeof(Config), 
+                    (const uint8_t *)from);
+    NVMem_flush();
+}
+
+static void
+readBoth(void)
+{
+    NVMemSeg segs[2];
+
+    segs[0].addr = CONFIG_MAIN_ADDR;
+    segs[0].buf = (uint8_t *)&block;
+    segs[1].addr = CONFIG_BACKUP_ADDR;
+    segs[1].buf = (uint8_t *)&backupBlock;
+    segs[0].nBytes = segs[1].nBytes = sizeof(Config);
+    NVMem_readv(segs, 2);
+}
+
 static ConfigErrorCode
 proc_in_error(void)
 {
     block = configDefault;
-    block.crc = Crc32_calc((const uint8_t *)&block.data, 
-                           sizeof(ConfigData), 0xffffffff);
-    NVMem_storeData(CONFIG_MAIN_ADDR, sizeof(Config), 
-                    (const uint8_t *)&block);
-    NVMem_storeData(CONFIG_BACKUP_ADDR, sizeof(Config), 
-                    (const uint8_t *)&block);
+#if CRC32_CT_IEEE == 1
+    storeBoth(&configDefault);
+#else
+    block.crc = CRC32_CALC_FIXED((const uint8_t *)&block.data, 
+                                 sizeof(ConfigData), 0xffffffff);
+    storeBoth(&block);
+#endif
     return CORRUPT_DATA;
 }
 
@@ -124,6 +188,7 @@ proc_recovery(void)
     block = backupBlock;
     NVMem_storeData(CONFIG_MAIN_ADDR, sizeof(Config), 
                     (const uint8_t *)&block);
+    NVMem_flush();
     return RECOVER_DATA;
 }
 
@@ -132,6 +197,7 @@ proc_backup(void)
 {
     NVMem_storeData(CONFIG_BACKUP_ADDR, sizeof(Config), 
                     (const uint8_t *)&block);
+    NVMem_flush();
     return BACKUP_DATA;
 }
 
@@ -151,19 +217,39 @@ proc_cmp(void)
 ConfigErrorCode
 Config_init(void)
 {
+    static const size_t lens[] = {sizeof(ConfigData), sizeof(ConfigData)};
+    const Config *mainCopy, *backupCopy;
+    const uint8_t *bufs[2];
+    Crc32 crcs[2];
     int status;
 
     Crc32_init();
-    NVMem_readData(CONFIG_MAIN_ADDR, sizeof(Config), 
-                   (uint8_t *)&block);
-    main.readCRC = Crc32_calc((const uint8_t *)&block.data, 
-                              sizeof(ConfigData), 0xffffffff);
-    main.result = (main.readCRC == block.crc) ? 1 : 0;
-    NVMem_readData(CONFIG_BACKUP_ADDR, sizeof(Config), 
-                   (uint8_t *)&backupBlock);
-    backup.readCRC = Crc32_calc((const uint8_t *)&backupBlock.data, 
-                                sizeof(ConfigData), 0xffffffff);
-    backup.result = (backup.readCRC == backupBlock.crc) ? 1 : 0;
+    mainCopy = NVMem_map(CONFIG_MAIN_ADDR, sizeof(Config));
+    backupCopy = NVMem_map(CONFIG_BACKUP_ADDR, sizeof(Config));
+    if ((mainCopy == (const Config *)0) || (backupCopy == (const Config *)0))
+    {
+        readBoth();
+        mainCopy = &block;
+        backupCopy = &backupBlock;
+    }
+    bufs[0] = (const uint8_t *)&mainCopy->data;
+    bufs[1] = (const uint8_t *)&backupCopy->data;
+    Crc32_calcMulti(bufs, lens, crcs, 2);
+    main.readCRC = crcs[0];
+    main.result = (main.readCRC == mainCopy->crc) ? 1 : 0;
+    backup.readCRC = crcs[1];
+    backup.result = (backup.readCRC == backupCopy->crc) ? 1 : 0;
+    if (mainCopy != &block)
+    {
+        if (main.result != 0)
+        {
+            block = *mainCopy;
+        }
+        else
+        {
+            backupBlock = *backupCopy;
+        }
+    }
     status = 0;
     status = (main.result << 1) | backup.result;
     return (*recovery[status])();
@@ -186,12 +272,9 @@ bool
 Config_setOptionA(int value)
 {
     block.data.optionA = value;
-    block.crc = Crc32_calc((const uint8_t *)&block.data, 
-                           sizeof(ConfigData), 0xffffffff);
-    NVMem_storeData(CONFIG_MAIN_ADDR, sizeof(Config), 
-                    (const uint8_t *)&block.data);
-    NVMem_storeData(CONFIG_BACKUP_ADDR, sizeof(Config), 
-                    (const uint8_t *)&block.data);
+    block.crc = CRC32_CALC_FIXED((const uint8_t *)&block.data, 
+                                 sizeof(ConfigData), 0xffffffff);
+    storeBoth(&block);
     return true;
 }
 
@@ -19,10 +19,12 @@
 
 /* --------------------------------- Notes --------------------------------- */
 /* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
 #include "unity.h"
 #include "Config.h"
 #include "Mock_NVMem.h"
 #include "Mock_Crc32.h"
+#include "Crc32_ref.h"
 
 /* ----------------------------- Local macros ------------------------------ */
 /* ------------------------------- Constants ------------------------------- */
@@ -69,11 +71,45 @@ static const Config configDefault =
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
 static void
-cbNVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to, 
-                 int cmock_num_calls)
+cbNVMem_readv(const NVMemSeg *segs, uint32_t nSegs, int cmock_num_calls)
 {
-    TEST_ASSERT_FALSE(cmock_num_calls > 1);
-    *((Config *)to) = cfgRead[cmock_num_calls].data;
+    int i;
+
+    TEST_ASSERT_FALSE(cmock_num_calls > 0);
+    TEST_ASSERT_EQUAL(2, nSegs);
+    TEST_ASSERT_EQUAL(CONFIG_MAIN_ADDR, segs[MAIN_BLOCK_IX].addr);
+    TEST_ASSERT_EQUAL(CONFIG_BACKUP_ADDR, segs[BACKUP_BLOCK_IX].addr);
+    for (i = MAIN_BLOCK_IX; i <= BACKUP_BLOCK_IX; ++i)
+    {
+        TEST_ASSERT_EQUAL(sizeof(Config), segs[i].nBytes);
+        *((Config *)segs[i].buf) = cfgRead[i].data;
+    }
+}
+
+static void
+cbCrc32_calcMulti(const uint8_t **bufs, const size_t *lens, Crc32 *out, 
+                  size_t n, int cmock_num_calls)
+{
+    int i;
+
+    TEST_ASSERT_FALSE(cmock_num_calls > 0);
+    TEST_ASSERT_EQUAL(2, n);
+    for (i = MAIN_BLOCK_IX; i <= BACKUP_BLOCK_IX; ++i)
+    {
+        TEST_ASSERT_EQUAL(sizeof(ConfigData), lens[i]);
+        out[i] = cfgRead[i].readCRC;
+    }
+}
+
+static void
+checkStore(const uint8_t *from, int ix)
+{
+    if ((((Config *)from)->data.optionA != 
+         cfgStore[ix].data.data.optionA) ||
+        (((Config *)from)->crc != cfgStore[ix].data.crc))
+    {
+        TEST_FAIL();
+    }
 }
 
 static void
@@ -81,29 +117,34 @@ cbNVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from,
                   int cmock_num_calls)
 {
     TEST_ASSERT_FALSE(cmock_num_calls > 1);
-    if (((Config *)from)->data.optionA != 
-        cfgStore[cmock_num_calls].data.data.optionA)
+    checkStore(from, cmock_num_calls);
+}
+
+static void
+initMapped(bool mapped)
+{
+    Crc32_init_Expect();
+    NVMem_map_ExpectAndReturn(CONFIG_MAIN_ADDR, sizeof(Config), 
+                              mapped ? &cfgRead[MAIN_BLOCK_IX].data : 0);
+    NVMem_map_ExpectAndReturn(CONFIG_BACKUP_ADDR, sizeof(Config), 
+                              mapped ? &cfgRead[BACKUP_BLOCK_IX].data : 0);
+    if (!mapped)
     {
-        TEST_FAIL();
+        NVMem_readv_Expect(0, 2);
+        NVMem_readv_IgnoreArg_segs();
+        NVMem_readv_StubWithCallback(cbNVMem_readv);
     }
+    Crc32_calcMulti_Expect(0, 0, 0, 2);
+    Crc32_calcMulti_IgnoreArg_bufs();
+    Crc32_calcMulti_IgnoreArg_lens();
+    Crc32_calcMulti_IgnoreArg_out();
+    Crc32_calcMulti_StubWithCallback(cbCrc32_calcMulti);
 }
 
 static void
-init(TestConfig *mRead, TestConfig *bRead)
+init(void)
 {
-    Crc32_init_Expect();
-    NVMem_readData_Expect(CONFIG_MAIN_ADDR, sizeof(Config), 0);
-    NVMem_readData_IgnoreArg_to();
-    NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(ConfigData), 0xffffffff, 
-                               mRead->readCRC);
-    Crc32_calc_IgnoreArg_buf();
-    NVMem_readData_Expect(CONFIG_BACKUP_ADDR, sizeof(Config), 0);
-    NVMem_readData_IgnoreArg_to();
-    NVMem_readData_StubWithCallback(cbNVMem_readData);
-    Crc32_calc_ExpectAndReturn(0, sizeof(ConfigData), 0xffffffff, 
-                               bRead->readCRC);
-    Crc32_calc_IgnoreArg_buf();
+    initMapped(false);
 }
 
 /* ---------------------------- Global functions --------------------------- */
@@ -129,19 +170,21 @@ test_InitBothBlocksAreCorrupted(void)
     cfgRead[MAIN_BLOCK_IX].readCRC = ~cfgRead[MAIN_BLOCK_IX].data.crc;
     cfgRead[BACKUP_BLOCK_IX].data.crc = 0xdeadbeef;
     cfgRead[BACKUP_BLOCK_IX].readCRC = ~cfgRead[BACKUP_BLOCK_IX].data.crc;
-    init(&cfgRead[MAIN_BLOCK_IX], &cfgRead[BACKUP_BLOCK_IX]);
+    init();
 
     cfgStore[MAIN_BLOCK_IX].data = configDefault;
-    cfgStore[BACKUP_BLOCK_IX].data = configDefault;
-    Crc32_calc_ExpectAndReturn(0, sizeof(ConfigData), 0xffffffff, 
-                               cfgRead[MAIN_BLOCK_IX].data.crc);
-    Crc32_calc_IgnoreArg_buf();
+    cfgStore[MAIN_BLOCK_IX].data.crc = 
+        Crc32Ref_calc((const uint8_t *)&configDefault.data, 
+                      sizeof(ConfigData), 0xffffffff);
+    cfgStore[BACKUP_BLOCK_IX].data = cfgStore[MAIN_BLOCK_IX].data;
     NVMem_storeData_Expect(CONFIG_MAIN_ADDR, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
+    NVMem_flush_Expect();
     NVMem_storeData_Expect(CONFIG_BACKUP_ADDR, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
+    NVMem_flush_Expect();
 
     res = Config_init();
     TEST_ASSERT_EQUAL(CORRUPT_DATA, res);
@@ -158,13 +201,14 @@ test_InitRecoveryData(void)
     cfgRead[BACKUP_BLOCK_IX].data = configDefault;
     cfgRead[BACKUP_BLOCK_IX].data.crc = 0xdeadbeef;
     cfgRead[BACKUP_BLOCK_IX].readCRC = cfgRead[BACKUP_BLOCK_IX].data.crc;
-    init(&cfgRead[MAIN_BLOCK_IX], &cfgRead[BACKUP_BLOCK_IX]);
+    init();
 
     cfgStore[MAIN_BLOCK_IX].data = cfgRead[BACKUP_BLOCK_IX].data;
     cfgStore[MAIN_BLOCK_IX].data.crc = cfgRead[BACKUP_BLOCK_IX].data.crc;
     NVMem_storeData_Expect(CONFIG_MAIN_ADDR, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
+    NVMem_flush_Expect();
 
     res = Config_init();
     TEST_ASSERT_EQUAL(RECOVER_DATA, res);
@@ -181,13 +225,14 @@ test_InitBackupData(void)
     cfgRead[BACKUP_BLOCK_IX].data = configDefault;
     cfgRead[BACKUP_BLOCK_IX].data.crc = 0xdeadbeef;
     cfgRead[BACKUP_BLOCK_IX].readCRC = ~cfgRead[BACKUP_BLOCK_IX].data.crc;
-    init(&cfgRead[MAIN_BLOCK_IX], &cfgRead[BACKUP_BLOCK_IX]);
+    init();
 
     cfgStore[MAIN_BLOCK_IX].data = cfgRead[MAIN_BLOCK_IX].data;
     cfgStore[MAIN_BLOCK_IX].data.crc = cfgRead[MAIN_BLOCK_IX].data.crc;
     NVMem_storeData_Expect(CONFIG_BACKUP_ADDR, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
+    NVMem_flush_Expect();
 
     res = Config_init();
     TEST_ASSERT_EQUAL(BACKUP_DATA, res);
@@ -204,7 +249,7 @@ test_InitBothBlocksAreHealthy(void)
     cfgRead[BACKUP_BLOCK_IX].data = configDefault;
     cfgRead[BACKUP_BLOCK_IX].data.crc = 0xdeadbeef;
     cfgRead[BACKUP_BLOCK_IX].readCRC = cfgRead[BACKUP_BLOCK_IX].data.crc;
-    init(&cfgRead[MAIN_BLOCK_IX], &cfgRead[BACKUP_BLOCK_IX]);
+    init();
 
     res = Config_init();
     TEST_ASSERT_EQUAL(NO_ERRORS, res);
@@ -221,16 +266,41 @@ test_InitBothBlocksAreHealthyButTheyAreDifferent(void)
     cfgRead[BACKUP_BLOCK_IX].data = configDefault;
     cfgRead[BACKUP_BLOCK_IX].data.crc = 0xdeaddead;
     cfgRead[BACKUP_BLOCK_IX].readCRC = cfgRead[BACKUP_BLOCK_IX].data.crc;
-    init(&cfgRead[MAIN_BLOCK_IX], &cfgRead[BACKUP_BLOCK_IX]);
+    init();
 
     cfgStore[MAIN_BLOCK_IX].data = cfgRead[MAIN_BLOCK_IX].data;
     cfgStore[MAIN_BLOCK_IX].data.crc = cfgRead[MAIN_BLOCK_IX].data.crc;
     NVMem_storeData_Expect(CONFIG_BACKUP_ADDR, sizeof(Config), 0);
     NVMem_storeData_IgnoreArg_from();
     NVMem_storeData_StubWithCallback(cbNVMem_storeData);
+    NVMem_flush_Expect();
 
     res = Config_init();
     TEST_ASSERT_EQUAL(BACKUP_DATA, res);
 }
 
+void
+test_InitCheckingMappedBlocksInPlace(void)
+{
+    ConfigErrorCode res;
+
+    cfgRead[MAIN_BLOCK_IX].data = configDefault;
+    cfgRead[MAIN_BLOCK_IX].data.crc = 0xffffffff;
+    cfgRead[MAIN_BLOCK_IX].readCRC = ~cfgRead[MAIN_BLOCK_IX].data.crc;
+    cfgRead[BACKUP_BLOCK_IX].data = configDefault;
+    cfgRead[BACKUP_BLOCK_IX].data.data.optionA = 32;
+    cfgRead[BACKUP_BLOCK_IX].data.crc = 0xdeadbeef;
+    cfgRead[BACKUP_BLOCK_IX].readCRC = cfgRead[BACKUP_BLOCK_IX].data.crc;
+    initMapped(true);
+
+    cfgStore[MAIN_BLOCK_IX].data = cfgRead[BACKUP_BLOCK_IX].data;
+    NVMem_storeData_Expect(CONFIG_MAIN_ADDR, sizeof(Config), 0);
+    NVMem_storeData_IgnoreArg_from();
+    NVMem_storeData_StubWithCallback(cbNVMem_storeData);
+    NVMem_flush_Expect();
+
+    res = Config_init();
+    TEST_ASSERT_EQUAL(RECOVER_DATA, res);
+}
+
 /* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,117 @@
+/*
+ * ---------------------------------------------------------------------------
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_ConfigOnFlash.c
+ *  \brief  Measures the cost of Config on a simulated flash part.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  Config runs on top of NVMem_sim.c instead of the NVMem mock, so that 
+ *  the boot time, the store time and the write amplification of the 
+ *  block layout can be measured. They are printed, in simulated time, 
+ *  for the default geometry and timing of NVMem_sim.h.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdio.h>
+#include "unity.h"
+#include "Config.h"
+#include "NVMem_sim.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemSimStats stats;
+static uint64_t start;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+begin(void)
+{
+    NVMemSim_resetStats();
+    start = NVMemSim_now();
+}
+
+static void
+report(const char *what)
+{
+    NVMemSim_getStats(&stats);
+    printf("%-12s %8.3f ms, %u page reads, %u page programs, "
+           "%u erases, write amplification %.1f\n", 
+           what, (NVMemSim_now() - start) / 1e6, stats.nReads, stats.nPrograms, 
+           stats.nErases,
+           (stats.bytesStored != 0) ? 
+               (double)stats.bytesProgrammed / stats.bytesStored : 0.0);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    NVMemSimCfg cfg = NVMEM_SIM_DFT_CFG;
+
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+}
+
+void
+tearDown(void)
+{
+    NVMemSim_close();
+}
+
+void
+test_BootFromABlankPart(void)
+{
+    begin();
+    TEST_ASSERT_EQUAL(CORRUPT_DATA, Config_init());
+    report("blank boot");
+    TEST_ASSERT_EQUAL(0, stats.nErases);
+}
+
+void
+test_BootFromAValidPart(void)
+{
+    Config_init();
+    begin();
+    TEST_ASSERT_EQUAL(NO_ERRORS, Config_init());
+    report("warm boot");
+    TEST_ASSERT_EQUAL(0, stats.nPrograms);
+}
+
+void
+test_SetAnOption(void)
+{
+    int value;
+
+    Config_init();
+    begin();
+    TEST_ASSERT_TRUE(Config_setOptionA(1234));
+    report("set option");
+    TEST_ASSERT_TRUE(stats.nErases > 0);
+
+    TEST_ASSERT_EQUAL(NO_ERRORS, Config_init());
+    TEST_ASSERT_TRUE(Config_getOptionA(&value));
+    TEST_ASSERT_EQUAL(1234, value);
+}
+
+/* ------------------------------ End of file ------------------------------ */
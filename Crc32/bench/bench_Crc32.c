@@ -0,0 +1,282 @@
+/**
+ *  \file       bench_Crc32.c
+ *  \brief      Throughput benchmark of the CRC-32 kernels.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is linked once per kernel by bench/Makefile, which names it by 
+ *  means of BENCH_KERNEL. It sweeps message sizes from 16 bytes, the 
+ *  size of a Config block, up to the size given as argument (64 MiB by 
+ *  default), and writes a JSON object to stdout:
+ *
+ *      {"kernel": "slice8", "check": true, "results": [
+ *          {"size": 16, "calls": 1048576, "ns_per_call": 9.1, 
+ *           "bytes_per_cycle": 0.61, "mib_per_s": 1677.2, "ok": true},
+ *          ...]}
+ *
+ *  Every size is timed BENCH_RUNS times, each run lasting at least 
+ *  BENCH_MIN_NS, and the fastest run is reported. Cycles are read from 
+ *  the TSC, so they tick at the nominal frequency of the CPU, and 
+ *  bytes_per_cycle is null on hosts without it.
+ *
+ *  "check" tells whether the kernel returns CHECK_VALUE for "123456789". 
+ *  Every result is also compared against a bitwise reference, except 
+ *  the ones of the stub Crc32.c (BENCH_STUB), which always returns 
+ *  CHECK_VALUE. The exit status is not zero on any mismatch.
+ *
+ *  BENCH_PARALLEL times Crc32_calcParallel() with a thread per online 
+ *  CPU. BENCH_STM32_SIM runs Crc32_stm32.c on the simulated CRC unit of 
+ *  test/support, whose speed means nothing, so it adds the number of 
+ *  words written to the unit per call, "unit_words", which is what a 
+ *  call costs on the target.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "Crc32.h"
+#if defined(BENCH_PARALLEL)
+#include <unistd.h>
+#include "Crc32_parallel.h"
+#endif
+#if defined(BENCH_STM32_SIM)
+#include "crc.h"
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC               1
+#else
+#define BENCH_TSC               0
+#endif
+
+/* ----------------------------- Local macros ------------------------------ */
+#ifndef BENCH_KERNEL
+#define BENCH_KERNEL            "unknown"
+#endif
+
+#define BENCH_RUNS              5
+#define BENCH_MIN_NS            20000000.0
+#define MIN_SIZE                16
+#define DFT_MAX_SIZE            (64 * 1024 * 1024)
+#define POLYNOMIAL_REFLECTED    0xEDB88320
+
+/* ------------------------------- Constants ------------------------------- */
+#define CHECK_VALUE             0xCBF43926
+
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Sample Sample;
+struct Sample
+{
+    double ns;
+    double cycles;
+};
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static volatile Crc32 sink;
+#if defined(BENCH_PARALLEL)
+static int nThreads;
+#endif
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static Crc32
+calc(const uint8_t *buf, size_t len)
+{
+#if defined(BENCH_PARALLEL)
+    return Crc32_calcParallel(buf, len, 0xffffffff, nThreads);
+#else
+    return Crc32_calc(buf, len, 0xffffffff);
+#endif
+}
+
+static Crc32
+refUpdate(Crc32 remainder, const uint8_t *buf, size_t len)
+{
+    int bit;
+
+    for (; len != 0; --len, ++buf)
+    {
+        remainder ^= *buf;
+        for (bit = 0; bit < 8; ++bit)
+        {
+            remainder = (remainder >> 1) ^ 
+                        (POLYNOMIAL_REFLECTED & (0 - (remainder & 0x01)));
+        }
+    }
+    return remainder;
+}
+
+static double
+nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+static uint64_t
+nowCycles(void)
+{
+#if BENCH_TSC == 1
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static Sample
+timeCalls(const uint8_t *buf, size_t len, unsigned long calls)
+{
+    Sample sample;
+    unsigned long i;
+    uint64_t startCycles;
+    double start;
+
+    start = nowNs();
+    startCycles = nowCycles();
+    for (i = 0; i < calls; ++i)
+    {
+        sink = calc(buf, len);
+    }
+    sample.cycles = (double)(nowCycles() - startCycles);
+    sample.ns = nowNs() - start;
+    return sample;
+}
+
+static Sample
+bench(const uint8_t *buf, size_t len, unsigned long *calls)
+{
+    Sample best, sample;
+    int run;
+
+    for (*calls = 1; ; *calls *= 2)
+    {
+        best = timeCalls(buf, len, *calls);
+        if (best.ns >= BENCH_MIN_NS)
+        {
+            break;
+        }
+    }
+    for (run = 1; run < BENCH_RUNS; ++run)
+    {
+        sample = timeCalls(buf, len, *calls);
+        if (sample.ns < best.ns)
+        {
+            best = sample;
+        }
+    }
+    return best;
+}
+
+static void
+fill(uint8_t *buf, size_t len)
+{
+    uint32_t seed = 0xc0ffee;
+
+    for (; len != 0; --len, ++buf)
+    {
+        seed = seed * 1103515245 + 12345;
+        *buf = (uint8_t)(seed >> 16);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+int
+main(int argc, char *argv[])
+{
+    size_t maxSize, size, refSize;
+    uint8_t *buf;
+    unsigned long calls;
+    Sample sample;
+    Crc32 ref, crc;
+    bool check, ok, allOk;
+    const char *sep = "";
+#if defined(BENCH_STM32_SIM)
+    uint32_t unitWords;
+#endif
+
+    maxSize = (argc > 1) ? strtoul(argv[1], NULL, 0) : DFT_MAX_SIZE;
+    maxSize = (maxSize < MIN_SIZE) ? MIN_SIZE : maxSize;
+    buf = aligned_alloc(64, (maxSize + 63) & ~(size_t)63);
+    if (buf == NULL)
+    {
+        fprintf(stderr, "bench_Crc32: out of memory\n");
+        return EXIT_FAILURE;
+    }
+    fill(buf, maxSize);
+
+#if defined(BENCH_STM32_SIM)
+    MX_CRC_Init();
+#endif
+#if defined(BENCH_PARALLEL)
+    nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    Crc32_init();
+    check = calc((const uint8_t *)"123456789", 9) == CHECK_VALUE;
+    allOk = check;
+
+    printf("{\"kernel\": \"%s\", \"check\": %s, \"results\": [", 
+           BENCH_KERNEL, check ? "true" : "false");
+    ref = 0xffffffff;
+    refSize = 0;
+    for (size = MIN_SIZE; size <= maxSize; size *= 4)
+    {
+        ref = refUpdate(ref, buf + refSize, size - refSize);
+        refSize = size;
+#if defined(BENCH_STM32_SIM)
+        CrcSim_nWrites = 0;
+#endif
+        crc = calc(buf, size);
+#if defined(BENCH_STM32_SIM)
+        unitWords = CrcSim_nWrites;
+#endif
+#if defined(BENCH_STUB)
+        ok = crc == CHECK_VALUE;
+#else
+        ok = crc == (ref ^ 0xffffffff);
+#endif
+        allOk = allOk && ok;
+
+        sample = bench(buf, size, &calls);
+        printf("%s\n    {\"size\": %zu, \"calls\": %lu, "
+               "\"ns_per_call\": %.1f, ", 
+               sep, size, calls, sample.ns / calls);
+        if (BENCH_TSC == 1)
+        {
+            printf("\"bytes_per_cycle\": %.3f, ", 
+                   ((double)size * calls) / sample.cycles);
+        }
+        else
+        {
+            printf("\"bytes_per_cycle\": null, ");
+        }
+#if defined(BENCH_STM32_SIM)
+        printf("\"unit_words\": %lu, ", (unsigned long)unitWords);
+#endif
+        printf("\"mib_per_s\": %.1f, \"ok\": %s}",
+               ((double)size * calls * 1e9) / (sample.ns * 1024 * 1024), 
+               ok ? "true" : "false");
+        sep = ",";
+    }
+    printf("\n]}\n");
+
+    free(buf);
+    return allOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -13,6 +13,36 @@
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  A CRC can be calculated in a single call by means of Crc32_calc() or, 
+ *  when the message is scattered, by feeding its pieces in order:
+ *
+ *      Crc32_begin(&ctx, 0xffffffff);
+ *      Crc32_update(&ctx, header, sizeof(header));
+ *      Crc32_update(&ctx, payload, nBytes);
+ *      crc = Crc32_final(&ctx);
+ *
+ *  The result is the same as the one of Crc32_calc() over the 
+ *  concatenation of these pieces.
+ *
+ *  Crc32_copyCalc() copies len bytes from src to dst and returns the CRC 
+ *  of them, in a single pass over src. The buffers must not overlap.
+ *
+ *  Crc32_calcMulti() calculates the CRCs of n independent buffers at 
+ *  once, out[i] = Crc32_calc(bufs[i], lens[i], 0xffffffff). It is faster 
+ *  than n calls to Crc32_calc() on short buffers, e.g. to verify the 
+ *  copies of a block or to scrub a set of blocks.
+ *
+ *  Crc32_combine() returns the CRC of the concatenation of two messages 
+ *  A and B from their CRCs and the length of B. Crc32_patch() returns 
+ *  the CRC of a message after replacing nBytes at offset, from the CRC 
+ *  of the original message and the replaced bytes only. Both take 
+ *  O(log n) time on the message length and assume CRCs calculated with 
+ *  the 0xffffffff init value. The replaced bytes must lie within the 
+ *  message, offset + nBytes <= totalLen, otherwise Crc32_patch() 
+ *  returns oldCrc unchanged.
+ */
+
 /* --------------------------------- Module -------------------------------- */
 #ifndef __CRC32_H__
 #define __CRC32_H__
@@ -27,14 +57,63 @@ extern "C" {
 #endif
 
 /* --------------------------------- Macros -------------------------------- */
+/**
+ *  Calculates the CRC of a message whose length is known at compile time, 
+ *  usually a sizeof(). If there is a fixed-length kernel for that length, 
+ *  the compiler folds the selection and calls it directly, otherwise it 
+ *  calls Crc32_calc().
+ */
+#define CRC32_CALC_FIXED(buf, len, init) \
+    (((len) == 4) ? Crc32_calc4((buf), (init)) : \
+     ((len) == 8) ? Crc32_calc8((buf), (init)) : \
+     ((len) == 12) ? Crc32_calc12((buf), (init)) : \
+     ((len) == 16) ? Crc32_calc16((buf), (init)) : \
+     ((len) == 20) ? Crc32_calc20((buf), (init)) : \
+     ((len) == 24) ? Crc32_calc24((buf), (init)) : \
+     ((len) == 28) ? Crc32_calc28((buf), (init)) : \
+     ((len) == 32) ? Crc32_calc32((buf), (init)) : \
+     Crc32_calc((buf), (len), (init)))
+
 /* -------------------------------- Constants ------------------------------ */
 /* ------------------------------- Data types ------------------------------ */
 typedef uint32_t Crc32;
 
+typedef struct Crc32Ctx Crc32Ctx;
+struct Crc32Ctx
+{
+    Crc32 remainder;
+};
+
+typedef struct Crc32Shift Crc32Shift;
+struct Crc32Shift
+{
+    Crc32 op[32];
+};
+
 /* -------------------------- External variables --------------------------- */
 /* -------------------------- Function prototypes -------------------------- */
 void Crc32_init(void);
 Crc32 Crc32_calc(const uint8_t *buf, size_t len, Crc32 init);
+Crc32 Crc32_calc4(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_calc8(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_calc12(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_calc16(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_calc20(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_calc24(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_calc28(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_calc32(const uint8_t *buf, Crc32 init);
+Crc32 Crc32_copyCalc(uint8_t *dst, const uint8_t *src, size_t len, 
+                     Crc32 init);
+void Crc32_calcMulti(const uint8_t *bufs[], const size_t lens[], 
+                     Crc32 out[], size_t n);
+void Crc32_begin(Crc32Ctx *ctx, Crc32 init);
+void Crc32_update(Crc32Ctx *ctx, const uint8_t *buf, size_t len);
+Crc32 Crc32_final(const Crc32Ctx *ctx);
+Crc32 Crc32_combine(Crc32 crcA, Crc32 crcB, size_t lenB);
+void Crc32_combineGen(Crc32Shift *shift, size_t lenB);
+Crc32 Crc32_combineOp(const Crc32Shift *shift, Crc32 crcA, Crc32 crcB);
+Crc32 Crc32_patch(Crc32 oldCrc, size_t offset, const uint8_t *oldBytes, 
+                  const uint8_t *newBytes, size_t nBytes, size_t totalLen);
 
 /* -------------------- External C language linkage end -------------------- */
 #ifdef __cplusplus
@@ -0,0 +1,77 @@
+/**
+ *  \file       Crc32_clmul.h
+ *  \brief      Specification of the carry-less multiply CRC-32 backend.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  Folds 64-byte blocks of the message by means of the x86-64 PCLMULQDQ 
+ *  instruction, following "Fast CRC Computation for Generic Polynomials 
+ *  Using PCLMULQDQ Instruction" (Intel, 2009). It is only built on x86-64 
+ *  hosts. Crc32_init() of Crc32_sw.c checks the CPU at run-time and uses 
+ *  it for messages of CRC32_CLMUL_THRESHOLD bytes or more, which must not 
+ *  be less than 64, the shortest message it folds. Its folding 
+ *  constants are those of the 0x04C11DB7 polynomial, so it is left out 
+ *  when CRC32_POLYNOMIAL is another one.
+ *
+ *  Crc32_clmulFold() works on the reflected remainder, not final-XORed, 
+ *  the same one the table kernels use. Its length must be a multiple of 
+ *  16 bytes and not less than 64 bytes, the caller processes the rest.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __CRC32_CLMUL_H__
+#define __CRC32_CLMUL_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include "Crc32.h"
+#include "Crc32_ct.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#if defined(__x86_64__) && defined(__GNUC__) && \
+    !defined(CRC32_NO_CLMUL) && (CRC32_POLYNOMIAL == 0x04C11DB7)
+#define CRC32_CLMUL                 1
+#else
+#define CRC32_CLMUL                 0
+#endif
+
+/* -------------------------------- Constants ------------------------------ */
+#ifndef CRC32_CLMUL_THRESHOLD
+#define CRC32_CLMUL_THRESHOLD       64
+#endif
+
+#if CRC32_CLMUL_THRESHOLD < 64
+#error "CRC32_CLMUL_THRESHOLD must be 64 bytes or more"
+#endif
+
+/* ------------------------------- Data types ------------------------------ */
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool Crc32_clmulAvailable(void);
+Crc32 Crc32_clmulFold(Crc32 remainder, const uint8_t *message, 
+                      size_t nBytes);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,249 @@
+/**
+ *  \file       Crc32_ct.h
+ *  \brief      Compile-time CRC-32 tables and CRC-32 of constant images.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  Everything here is a constant expression derived from CRC32_POLYNOMIAL,
+ *  so that changing the polynomial only takes a new -DCRC32_POLYNOMIAL.
+ *
+ *  The reflected table is linear in its index: entry i is the XOR of the
+ *  entries of the bits set in i. The entry of bit b of slice k (the byte
+ *  followed by k zero bytes) is the reflected polynomial shifted
+ *  8k + 7 - b times, so they are chained one shift apart in the enum
+ *  below. The constants are split into 16-bit halves because enumerators
+ *  are ints.
+ *
+ *  CRC32_CT_DEFINE() chains up to CRC32_CT_MAX_LEN byte steps the same
+ *  way, one enumerator per step, to calculate the CRC-32 of a constant
+ *  image, e.g. a default configuration stored in flash:
+ *
+ *      #define DFT_BYTE(k) CRC32_CT_FIELD_BYTE(k, 64, int, 0)
+ *      CRC32_CT_DEFINE(dftCrc, sizeof(int), 0xffffffff, DFT_BYTE);
+ *      static const Crc32 crc = CRC32_CT_VALUE(dftCrc);
+ *
+ *  CRC32_CT_FIELD_BYTE() lays out the fields in little-endian order.
+ *
+ *  CRC32_CT_VALUE() is the IEEE CRC-32, the one Crc32_calc() returns only
+ *  when CRC32_CT_IEEE is 1. It is 0 with the default mode of 
+ *  Crc32_stm32.c, which requires CRC32_STM32 to be defined for the 
+ *  whole build, and then the CRC of a constant image must be calculated 
+ *  at run time.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __CRC32_CT_H__
+#define __CRC32_CT_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdint.h>
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "CRC32_CT_FIELD_BYTE() only supports little-endian targets"
+#endif
+
+#define CRC32_CT_R1(x)      ((((uint32_t)(x) >> 1) & 0x55555555) | \
+                             (((uint32_t)(x) & 0x55555555) << 1))
+#define CRC32_CT_R2(x)      ((((x) >> 2) & 0x33333333) | \
+                             (((x) & 0x33333333) << 2))
+#define CRC32_CT_R4(x)      ((((x) >> 4) & 0x0f0f0f0f) | \
+                             (((x) & 0x0f0f0f0f) << 4))
+#define CRC32_CT_R8(x)      ((((x) >> 8) & 0x00ff00ff) | \
+                             (((x) & 0x00ff00ff) << 8))
+#define CRC32_CT_REFLECT(x) (uint32_t)((CRC32_CT_R8(CRC32_CT_R4( \
+                                        CRC32_CT_R2(CRC32_CT_R1(x)))) >> \
+                                        16) | \
+                                       (CRC32_CT_R8(CRC32_CT_R4( \
+                                        CRC32_CT_R2(CRC32_CT_R1(x)))) << \
+                                        16))
+
+/* One bit shift of the reflected remainder n, given as 16-bit halves */
+#define CRC32_CT_SHIFT_HI(n) \
+    ((n##_HI >> 1) ^ ((n##_LO & 1) ? CRC32_CT_POLY_HI : 0))
+#define CRC32_CT_SHIFT_LO(n) \
+    (((n##_LO >> 1) | ((n##_HI & 1) << 15)) ^ \
+     ((n##_LO & 1) ? CRC32_CT_POLY_LO : 0))
+#define CRC32_CT_NEXT(n, prev) \
+    n##_HI = CRC32_CT_SHIFT_HI(prev), n##_LO = CRC32_CT_SHIFT_LO(prev)
+#define CRC32_CT_SLICE(k) \
+    CRC32_CT_NEXT(CRC32_CT_T##k##_6, CRC32_CT_T##k##_7), \
+    CRC32_CT_NEXT(CRC32_CT_T##k##_5, CRC32_CT_T##k##_6), \
+    CRC32_CT_NEXT(CRC32_CT_T##k##_4, CRC32_CT_T##k##_5), \
+    CRC32_CT_NEXT(CRC32_CT_T##k##_3, CRC32_CT_T##k##_4), \
+    CRC32_CT_NEXT(CRC32_CT_T##k##_2, CRC32_CT_T##k##_3), \
+    CRC32_CT_NEXT(CRC32_CT_T##k##_1, CRC32_CT_T##k##_2), \
+    CRC32_CT_NEXT(CRC32_CT_T##k##_0, CRC32_CT_T##k##_1)
+
+#define CRC32_CT_BIT(k, i, b) \
+    (((i) & (1u << b)) ? (((uint32_t)CRC32_CT_T##k##_##b##_HI << 16) | \
+                          CRC32_CT_T##k##_##b##_LO) : 0)
+
+/* Entry i of slice k */
+#define CRC32_CT_ENTRY(k, i) \
+    (CRC32_CT_BIT(k, i, 0) ^ CRC32_CT_BIT(k, i, 1) ^ \
+     CRC32_CT_BIT(k, i, 2) ^ CRC32_CT_BIT(k, i, 3) ^ \
+     CRC32_CT_BIT(k, i, 4) ^ CRC32_CT_BIT(k, i, 5) ^ \
+     CRC32_CT_BIT(k, i, 6) ^ CRC32_CT_BIT(k, i, 7))
+
+#define CRC32_CT_4(k, i)    CRC32_CT_ENTRY(k, i), \
+                            CRC32_CT_ENTRY(k, (i) + 1), \
+                            CRC32_CT_ENTRY(k, (i) + 2), \
+                            CRC32_CT_ENTRY(k, (i) + 3)
+#define CRC32_CT_16(k, i)   CRC32_CT_4(k, i), CRC32_CT_4(k, (i) + 4), \
+                            CRC32_CT_4(k, (i) + 8), CRC32_CT_4(k, (i) + 12)
+#define CRC32_CT_64(k, i)   CRC32_CT_16(k, i), CRC32_CT_16(k, (i) + 16), \
+                            CRC32_CT_16(k, (i) + 32), \
+                            CRC32_CT_16(k, (i) + 48)
+
+/* Initializer of the 256 entries of slice k, 0 <= k < 16 */
+#define CRC32_CT_TABLE(k)   CRC32_CT_64(k, 0), CRC32_CT_64(k, 64), \
+                            CRC32_CT_64(k, 128), CRC32_CT_64(k, 192)
+
+/* Initializer of the 16-entry table of the nibble kernel */
+#define CRC32_CT_NIBBLE(i)  CRC32_CT_ENTRY(0, (i) << 4), \
+                            CRC32_CT_ENTRY(0, ((i) + 1) << 4), \
+                            CRC32_CT_ENTRY(0, ((i) + 2) << 4), \
+                            CRC32_CT_ENTRY(0, ((i) + 3) << 4)
+#define CRC32_CT_NIBBLE_TABLE \
+    CRC32_CT_NIBBLE(0), CRC32_CT_NIBBLE(4), \
+    CRC32_CT_NIBBLE(8), CRC32_CT_NIBBLE(12)
+
+/*
+ *  Byte k of a constant image, given a field of the image: 'value' of
+ *  type 'type' placed at 'offset'. It is 0 outside of the field, so the
+ *  bytes of an image are the OR of its fields, padding included.
+ */
+#define CRC32_CT_FIELD_BYTE(k, value, type, offset) \
+    ((((k) >= (offset)) && ((k) < ((offset) + sizeof(type)))) ? \
+     (((unsigned long long)(value) >> (8 * (((k) - (offset)) & 7))) & \
+      0xff) : 0)
+
+/* One byte step of the chain of CRC32_CT_DEFINE() */
+#define CRC32_CT_FEED(name, p, n, len, byteOf) \
+    name##_##n##_X = (name##_##p##_LO ^ (byteOf(p))) & 0xff, \
+    name##_##n##_HI = ((p) < (len)) ? \
+        ((name##_##p##_HI >> 8) ^ \
+         (CRC32_CT_ENTRY(0, name##_##n##_X) >> 16)) : \
+        name##_##p##_HI, \
+    name##_##n##_LO = ((p) < (len)) ? \
+        ((((name##_##p##_LO >> 8) | ((name##_##p##_HI & 0xff) << 8)) ^ \
+          CRC32_CT_ENTRY(0, name##_##n##_X)) & 0xffff) : \
+        name##_##p##_LO
+
+/*
+ *  Defines 'name' as the CRC-32 of the 'len' bytes byteOf(0) ...
+ *  byteOf(len - 1), starting from 'init' as Crc32_calc() does. It is read
+ *  by means of CRC32_CT_VALUE(name).
+ */
+#define CRC32_CT_DEFINE(name, len, init, byteOf) \
+    _Static_assert((len) <= CRC32_CT_MAX_LEN, \
+                   "CRC32_CT_DEFINE() image too long"); \
+    enum \
+    { \
+        name##_0_HI = CRC32_CT_REFLECT(init) >> 16, \
+        name##_0_LO = CRC32_CT_REFLECT(init) & 0xffff, \
+        CRC32_CT_FEED(name, 0, 1, len, byteOf), \
+        CRC32_CT_FEED(name, 1, 2, len, byteOf), \
+        CRC32_CT_FEED(name, 2, 3, len, byteOf), \
+        CRC32_CT_FEED(name, 3, 4, len, byteOf), \
+        CRC32_CT_FEED(name, 4, 5, len, byteOf), \
+        CRC32_CT_FEED(name, 5, 6, len, byteOf), \
+        CRC32_CT_FEED(name, 6, 7, len, byteOf), \
+        CRC32_CT_FEED(name, 7, 8, len, byteOf), \
+        CRC32_CT_FEED(name, 8, 9, len, byteOf), \
+        CRC32_CT_FEED(name, 9, 10, len, byteOf), \
+        CRC32_CT_FEED(name, 10, 11, len, byteOf), \
+        CRC32_CT_FEED(name, 11, 12, len, byteOf), \
+        CRC32_CT_FEED(name, 12, 13, len, byteOf), \
+        CRC32_CT_FEED(name, 13, 14, len, byteOf), \
+        CRC32_CT_FEED(name, 14, 15, len, byteOf), \
+        CRC32_CT_FEED(name, 15, 16, len, byteOf), \
+        CRC32_CT_FEED(name, 16, 17, len, byteOf), \
+        CRC32_CT_FEED(name, 17, 18, len, byteOf), \
+        CRC32_CT_FEED(name, 18, 19, len, byteOf), \
+        CRC32_CT_FEED(name, 19, 20, len, byteOf), \
+        CRC32_CT_FEED(name, 20, 21, len, byteOf), \
+        CRC32_CT_FEED(name, 21, 22, len, byteOf), \
+        CRC32_CT_FEED(name, 22, 23, len, byteOf), \
+        CRC32_CT_FEED(name, 23, 24, len, byteOf), \
+        CRC32_CT_FEED(name, 24, 25, len, byteOf), \
+        CRC32_CT_FEED(name, 25, 26, len, byteOf), \
+        CRC32_CT_FEED(name, 26, 27, len, byteOf), \
+        CRC32_CT_FEED(name, 27, 28, len, byteOf), \
+        CRC32_CT_FEED(name, 28, 29, len, byteOf), \
+        CRC32_CT_FEED(name, 29, 30, len, byteOf), \
+        CRC32_CT_FEED(name, 30, 31, len, byteOf), \
+        CRC32_CT_FEED(name, 31, 32, len, byteOf) \
+    }
+
+#define CRC32_CT_VALUE(name) \
+    ((((uint32_t)name##_32_HI << 16) | (uint32_t)name##_32_LO) ^ \
+     CRC32_FINAL_XOR_VALUE)
+
+/* -------------------------------- Constants ------------------------------ */
+#ifndef CRC32_POLYNOMIAL
+#define CRC32_POLYNOMIAL            0x04C11DB7
+#endif
+#define CRC32_INITIAL_REMAINDER     0xFFFFFFFF
+#define CRC32_FINAL_XOR_VALUE       0xFFFFFFFF
+#define CRC32_POLY_REFLECTED        CRC32_CT_REFLECT(CRC32_POLYNOMIAL)
+#define CRC32_CT_MAX_LEN            32
+
+#if defined(CRC32_STM32) && !defined(CRC32_STM32_WORD_FED)
+#define CRC32_CT_IEEE               0
+#else
+#define CRC32_CT_IEEE               1
+#endif
+
+enum
+{
+    CRC32_CT_POLY_HI = CRC32_POLY_REFLECTED >> 16,
+    CRC32_CT_POLY_LO = CRC32_POLY_REFLECTED & 0xffff,
+    CRC32_CT_T0_7_HI = CRC32_CT_POLY_HI,
+    CRC32_CT_T0_7_LO = CRC32_CT_POLY_LO,
+    CRC32_CT_SLICE(0),
+    CRC32_CT_NEXT(CRC32_CT_T1_7, CRC32_CT_T0_0), CRC32_CT_SLICE(1),
+    CRC32_CT_NEXT(CRC32_CT_T2_7, CRC32_CT_T1_0), CRC32_CT_SLICE(2),
+    CRC32_CT_NEXT(CRC32_CT_T3_7, CRC32_CT_T2_0), CRC32_CT_SLICE(3),
+    CRC32_CT_NEXT(CRC32_CT_T4_7, CRC32_CT_T3_0), CRC32_CT_SLICE(4),
+    CRC32_CT_NEXT(CRC32_CT_T5_7, CRC32_CT_T4_0), CRC32_CT_SLICE(5),
+    CRC32_CT_NEXT(CRC32_CT_T6_7, CRC32_CT_T5_0), CRC32_CT_SLICE(6),
+    CRC32_CT_NEXT(CRC32_CT_T7_7, CRC32_CT_T6_0), CRC32_CT_SLICE(7),
+    CRC32_CT_NEXT(CRC32_CT_T8_7, CRC32_CT_T7_0), CRC32_CT_SLICE(8),
+    CRC32_CT_NEXT(CRC32_CT_T9_7, CRC32_CT_T8_0), CRC32_CT_SLICE(9),
+    CRC32_CT_NEXT(CRC32_CT_T10_7, CRC32_CT_T9_0), CRC32_CT_SLICE(10),
+    CRC32_CT_NEXT(CRC32_CT_T11_7, CRC32_CT_T10_0), CRC32_CT_SLICE(11),
+    CRC32_CT_NEXT(CRC32_CT_T12_7, CRC32_CT_T11_0), CRC32_CT_SLICE(12),
+    CRC32_CT_NEXT(CRC32_CT_T13_7, CRC32_CT_T12_0), CRC32_CT_SLICE(13),
+    CRC32_CT_NEXT(CRC32_CT_T14_7, CRC32_CT_T13_0), CRC32_CT_SLICE(14),
+    CRC32_CT_NEXT(CRC32_CT_T15_7, CRC32_CT_T14_0), CRC32_CT_SLICE(15)
+};
+
+/* ------------------------------- Data types ------------------------------ */
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,61 @@
+/**
+ *  \file       Crc32_parallel.h
+ *  \brief      Specification of the multithreaded CRC-32 for host builds.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The message is split into chunks which are hashed by a pool of POSIX 
+ *  threads and then stitched together by Crc32_combineOp(). The result 
+ *  is the same as the one of Crc32_calc(). 
+ *
+ *  By default the chunk is the size of the L2 cache, as reported by 
+ *  sysconf(), so that a worker hashes a chunk while the next one is 
+ *  being prefetched. Crc32_setChunkSize() overrides it, a zero value 
+ *  restores the default. Messages shorter than two chunks are hashed by 
+ *  the calling thread.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __CRC32_PARALLEL_H__
+#define __CRC32_PARALLEL_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include "Crc32.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+/* -------------------------------- Constants ------------------------------ */
+#ifndef CRC32_PAR_MAX_THREADS
+#define CRC32_PAR_MAX_THREADS       32
+#endif
+
+/* ------------------------------- Data types ------------------------------ */
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+Crc32 Crc32_calcParallel(const uint8_t *buf, size_t len, Crc32 init, 
+                         int nThreads);
+void Crc32_setChunkSize(size_t nBytes);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
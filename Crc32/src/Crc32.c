@@ -19,6 +19,13 @@
 /* ----------------------------- Local macros ------------------------------ */
 #define CHECK_VALUE			    0xCBF43926
 
+#define CRC32_FIXED_DEFINE(n) \
+    Crc32 \
+    Crc32_calc##n(const uint8_t *message, Crc32 init) \
+    { \
+        return CHECK_VALUE; \
+    }
+
 /* ------------------------------- Constants ------------------------------- */
 /* ---------------------------- Local data types --------------------------- */
 /* ---------------------------- Global variables --------------------------- */
@@ -37,4 +44,46 @@ Crc32_calc(const uint8_t *message, size_t nBytes, Crc32 init)
     return CHECK_VALUE;
 }
 
+Crc32
+Crc32_copyCalc(uint8_t *dst, const uint8_t *src, size_t nBytes, Crc32 init)
+{
+    return CHECK_VALUE;
+}
+
+void
+Crc32_calcMulti(const uint8_t *bufs[], const size_t lens[], Crc32 out[], 
+                size_t n)
+{
+    for (; n != 0; --n, ++out)
+    {
+        *out = CHECK_VALUE;
+    }
+}
+
+void
+Crc32_begin(Crc32Ctx *ctx, Crc32 init)
+{
+    ctx->remainder = init;
+}
+
+void
+Crc32_update(Crc32Ctx *ctx, const uint8_t *message, size_t nBytes)
+{
+}
+
+Crc32
+Crc32_final(const Crc32Ctx *ctx)
+{
+    return CHECK_VALUE;
+}
+
+CRC32_FIXED_DEFINE(4)
+CRC32_FIXED_DEFINE(8)
+CRC32_FIXED_DEFINE(12)
+CRC32_FIXED_DEFINE(16)
+CRC32_FIXED_DEFINE(20)
+CRC32_FIXED_DEFINE(24)
+CRC32_FIXED_DEFINE(28)
+CRC32_FIXED_DEFINE(32)
+
 /* ------------------------------ End of file ------------------------------ */
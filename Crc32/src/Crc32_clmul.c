@@ -0,0 +1,163 @@
+/**
+ *  \file       Crc32_clmul.c
+ *  \brief      Implementation of CRC-32 using carry-less multiplication.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The constants are the bit-reflected folding constants k1...k5 of the 
+ *  polynomial 0x04C11DB7, and the Barrett reduction pair (P(x)', u'), 
+ *  as given at the end of the Intel paper.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include "Crc32_clmul.h"
+
+#if CRC32_CLMUL == 1
+#include <cpuid.h>
+#include <immintrin.h>
+
+/* ----------------------------- Local macros ------------------------------ */
+#define CLMUL_TARGET        __attribute__((target("pclmul,sse4.1")))
+
+/* ------------------------------- Constants ------------------------------- */
+static const uint64_t k1k2[] __attribute__((aligned(16))) =
+{
+    0x0154442bd4, 0x01c6e41596
+};
+
+static const uint64_t k3k4[] __attribute__((aligned(16))) =
+{
+    0x01751997d0, 0x00ccaa009e
+};
+
+static const uint64_t k5k0[] __attribute__((aligned(16))) =
+{
+    0x0163cd6124, 0x0000000000
+};
+
+static const uint64_t poly[] __attribute__((aligned(16))) =
+{
+    0x01db710641, 0x01f7011641
+};
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static inline CLMUL_TARGET __m128i
+fold(__m128i acc, __m128i k, __m128i data)
+{
+    __m128i low;
+
+    low = _mm_clmulepi64_si128(acc, k, 0x00);
+    acc = _mm_clmulepi64_si128(acc, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(acc, low), data);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+Crc32_clmulAvailable(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return false;
+    }
+    return ((ecx & bit_PCLMUL) != 0) && ((ecx & bit_SSE4_1) != 0);
+}
+
+CLMUL_TARGET Crc32
+Crc32_clmulFold(Crc32 remainder, const uint8_t *message, size_t nBytes)
+{
+    __m128i x0, x1, x2, x3, x4, mask;
+
+    /* Load the first 64-byte block and fold the remainder into it */
+    x1 = _mm_loadu_si128((const __m128i *)(message + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(message + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(message + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(message + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)remainder));
+    message += 64;
+    nBytes -= 64;
+
+    /* Fold four 128-bit lanes in parallel */
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+    for (; nBytes >= 64; nBytes -= 64, message += 64)
+    {
+        x1 = fold(x1, x0, 
+                  _mm_loadu_si128((const __m128i *)(message + 0x00)));
+        x2 = fold(x2, x0, 
+                  _mm_loadu_si128((const __m128i *)(message + 0x10)));
+        x3 = fold(x3, x0, 
+                  _mm_loadu_si128((const __m128i *)(message + 0x20)));
+        x4 = fold(x4, x0, 
+                  _mm_loadu_si128((const __m128i *)(message + 0x30)));
+    }
+
+    /* Fold the four lanes into a single one */
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+    x1 = fold(x1, x0, x2);
+    x1 = fold(x1, x0, x3);
+    x1 = fold(x1, x0, x4);
+
+    /* Fold the remaining 16-byte blocks, if any */
+    for (; nBytes >= 16; nBytes -= 16, message += 16)
+    {
+        x1 = fold(x1, x0, _mm_loadu_si128((const __m128i *)message));
+    }
+
+    /* Fold 128 bits down to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction down to 32 bits */
+    x0 = _mm_load_si128((const __m128i *)poly);
+    x2 = _mm_and_si128(x1, mask);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, mask);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (Crc32)_mm_extract_epi32(x1, 1);
+}
+
+#else
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+Crc32_clmulAvailable(void)
+{
+    return false;
+}
+
+Crc32
+Crc32_clmulFold(Crc32 remainder, const uint8_t *message, size_t nBytes)
+{
+    (void)message;
+    (void)nBytes;
+    return remainder;
+}
+
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,192 @@
+/**
+ *  \file       Crc32_combine.c
+ *  \brief      Implementation of CRC-32 combination and patching.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  A CRC is linear over GF(2), so appending n zero bytes to a message 
+ *  multiplies its remainder by a 32x32 bit matrix. That matrix is raised 
+ *  to the n-th power by repeated squaring, as zlib's crc32_combine() 
+ *  does, which takes O(log n) matrix products instead of O(n) table 
+ *  lookups. When many CRCs are combined with the same length, as 
+ *  Crc32_calcParallel() does, the matrix is built once by 
+ *  Crc32_combineGen() and then each Crc32_combineOp() is a single 
+ *  matrix-vector product.
+ *
+ *  Both functions only depend on the CRC-32 parameters, not on the 
+ *  kernel or backend that calculated the given CRCs.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include "Crc32.h"
+#include "Crc32_ct.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+#define POLYNOMIAL_REFLECTED    CRC32_POLY_REFLECTED
+#define GF2_DIM                 32
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static Crc32
+gf2MatrixTimes(const Crc32 *mat, Crc32 vec)
+{
+    Crc32 sum;
+
+    for (sum = 0; vec != 0; vec >>= 1, ++mat)
+    {
+        if (vec & 0x01)
+        {
+            sum ^= *mat;
+        }
+    }
+    return sum;
+}
+
+static void
+gf2MatrixSquare(Crc32 *square, const Crc32 *mat)
+{
+    int n;
+
+    for (n = 0; n < GF2_DIM; ++n)
+    {
+        square[n] = gf2MatrixTimes(mat, mat[n]);
+    }
+}
+
+/* Replaces mat by (other x mat), that is, mat is applied first */
+static void
+gf2MatrixMult(Crc32 *mat, const Crc32 *other)
+{
+    int n;
+
+    for (n = 0; n < GF2_DIM; ++n)
+    {
+        mat[n] = gf2MatrixTimes(other, mat[n]);
+    }
+}
+
+/*
+ *  Builds the operator that appends nBytes zero bytes to a reflected 
+ *  remainder, without init and final XOR.
+ */
+static void
+zerosOperator(Crc32 *op, size_t nBytes)
+{
+    Crc32 even[GF2_DIM];    /* even-power-of-two zeros operator */
+    Crc32 odd[GF2_DIM];     /* odd-power-of-two zeros operator */
+    Crc32 row;
+    int n;
+
+    /* Start from the identity */
+    for (n = 0, row = 1; n < GF2_DIM; ++n, row <<= 1)
+    {
+        op[n] = row;
+    }
+    if (nBytes == 0)
+    {
+        return;
+    }
+
+    /* Operator for one zero bit */
+    odd[0] = POLYNOMIAL_REFLECTED;
+    for (n = 1, row = 1; n < GF2_DIM; ++n, row <<= 1)
+    {
+        odd[n] = row;
+    }
+    gf2MatrixSquare(even, odd);     /* two zero bits */
+    gf2MatrixSquare(odd, even);     /* four zero bits */
+
+    /* Accumulate the operator of each bit set in nBytes */
+    do
+    {
+        gf2MatrixSquare(even, odd);
+        if (nBytes & 0x01)
+        {
+            gf2MatrixMult(op, even);
+        }
+        nBytes >>= 1;
+        if (nBytes == 0)
+        {
+            break;
+        }
+
+        gf2MatrixSquare(odd, even);
+        if (nBytes & 0x01)
+        {
+            gf2MatrixMult(op, odd);
+        }
+        nBytes >>= 1;
+    } while (nBytes != 0);
+}
+
+static Crc32
+shiftZeros(Crc32 crc, size_t nBytes)
+{
+    Crc32 op[GF2_DIM];
+
+    zerosOperator(op, nBytes);
+    return gf2MatrixTimes(op, crc);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+Crc32
+Crc32_combine(Crc32 crcA, Crc32 crcB, size_t lenB)
+{
+    return shiftZeros(crcA, lenB) ^ crcB;
+}
+
+void
+Crc32_combineGen(Crc32Shift *shift, size_t lenB)
+{
+    zerosOperator(shift->op, lenB);
+}
+
+Crc32
+Crc32_combineOp(const Crc32Shift *shift, Crc32 crcA, Crc32 crcB)
+{
+    return gf2MatrixTimes(shift->op, crcA) ^ crcB;
+}
+
+Crc32
+Crc32_patch(Crc32 oldCrc, size_t offset, const uint8_t *oldBytes, 
+            const uint8_t *newBytes, size_t nBytes, size_t totalLen)
+{
+    Crc32 delta;
+    int bit;
+
+    if ((offset > totalLen) || (nBytes > (totalLen - offset)))
+    {
+        return oldCrc;
+    }
+
+    /* 
+     * The CRC of (old XOR new) is the change of the CRC. Since init and 
+     * final XOR cancel each other, it is calculated without them.
+     */
+    for (delta = 0; nBytes != 0; --nBytes, ++oldBytes, ++newBytes, ++offset)
+    {
+        delta ^= *oldBytes ^ *newBytes;
+        for (bit = 0; bit < 8; ++bit)
+        {
+            delta = (delta & 0x01) ? (delta >> 1) ^ POLYNOMIAL_REFLECTED : 
+                                     (delta >> 1);
+        }
+    }
+    return oldCrc ^ shiftZeros(delta, totalLen - offset);
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,228 @@
+/**
+ *  \file       Crc32_parallel.c
+ *  \brief      Implementation of the multithreaded CRC-32.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  Workers are started on demand and never exit. A call publishes a job, 
+ *  up to (nThreads - 1) workers join it and the calling thread works on 
+ *  it too. Chunks are claimed through an atomic counter, so a slow 
+ *  worker does not delay the others. Calls are serialized.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "Crc32_parallel.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+#define DFT_CHUNK_SIZE          (256 * 1024)
+#define MIN_CHUNK_SIZE          (4 * 1024)
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Job Job;
+struct Job
+{
+    const uint8_t *buf;
+    size_t len;
+    size_t chunkSize;
+    size_t nChunks;
+    Crc32 init;
+    Crc32 *crcs;
+    atomic_size_t next;
+    int nHelpers;       /* workers allowed to join */
+    int nJoined;        /* workers that joined */
+    int nRunning;       /* workers still hashing */
+};
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static pthread_mutex_t callLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobReady = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobDone = PTHREAD_COND_INITIALIZER;
+static Job *job;
+static unsigned long jobSeq;
+static int nWorkers;
+static size_t chunkSize;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+hashChunks(Job *me)
+{
+    size_t ix, len;
+
+    while ((ix = atomic_fetch_add(&me->next, 1)) < me->nChunks)
+    {
+        len = me->len - (ix * me->chunkSize);
+        len = (len < me->chunkSize) ? len : me->chunkSize;
+        me->crcs[ix] = Crc32_calc(me->buf + (ix * me->chunkSize), len, 
+                                  (ix == 0) ? me->init : 0xffffffff);
+    }
+}
+
+static void *
+worker(void *arg)
+{
+    unsigned long seen = 0;
+    Job *me;
+
+    (void)arg;
+    pthread_mutex_lock(&lock);
+    for (;;)
+    {
+        while (jobSeq == seen)
+        {
+            pthread_cond_wait(&jobReady, &lock);
+        }
+        seen = jobSeq;
+        me = job;
+        if ((me == (Job *)0) || (me->nJoined >= me->nHelpers))
+        {
+            continue;
+        }
+        ++me->nJoined;
+        ++me->nRunning;
+        pthread_mutex_unlock(&lock);
+
+        hashChunks(me);
+
+        pthread_mutex_lock(&lock);
+        if (--me->nRunning == 0)
+        {
+            pthread_cond_signal(&jobDone);
+        }
+    }
+    return (void *)0;
+}
+
+static size_t
+getChunkSize(void)
+{
+    long cacheSize;
+
+    if (chunkSize != 0)
+    {
+        return chunkSize;
+    }
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (cacheSize >= MIN_CHUNK_SIZE)
+    {
+        return (size_t)cacheSize;
+    }
+#else
+    (void)cacheSize;
+#endif
+    return DFT_CHUNK_SIZE;
+}
+
+static void
+startWorkers(int nThreads)
+{
+    pthread_t thread;
+
+    while (nWorkers < nThreads)
+    {
+        if (pthread_create(&thread, (const pthread_attr_t *)0, worker, 
+                           (void *)0) != 0)
+        {
+            break;
+        }
+        pthread_detach(thread);
+        ++nWorkers;
+    }
+}
+
+static Crc32
+stitch(const Job *me)
+{
+    Crc32Shift shift;
+    Crc32 crc;
+    size_t ix;
+
+    Crc32_combineGen(&shift, me->chunkSize);
+    for (crc = me->crcs[0], ix = 1; ix < (me->nChunks - 1); ++ix)
+    {
+        crc = Crc32_combineOp(&shift, crc, me->crcs[ix]);
+    }
+    return Crc32_combine(crc, me->crcs[ix], 
+                         me->len - (ix * me->chunkSize));
+}
+
+/* ---------------------------- Global functions --------------------------- */
+Crc32
+Crc32_calcParallel(const uint8_t *buf, size_t len, Crc32 init, int nThreads)
+{
+    Job me;
+    Crc32 crc;
+
+    me.chunkSize = getChunkSize();
+    if (nThreads > CRC32_PAR_MAX_THREADS)
+    {
+        nThreads = CRC32_PAR_MAX_THREADS;
+    }
+    if ((nThreads <= 1) || (len < (2 * me.chunkSize)))
+    {
+        return Crc32_calc(buf, len, init);
+    }
+
+    me.buf = buf;
+    me.len = len;
+    me.init = init;
+    me.nChunks = (len + me.chunkSize - 1) / me.chunkSize;
+    me.crcs = malloc(me.nChunks * sizeof(Crc32));
+    if (me.crcs == (Crc32 *)0)
+    {
+        return Crc32_calc(buf, len, init);
+    }
+    atomic_init(&me.next, 0);
+    me.nHelpers = nThreads - 1;
+    me.nJoined = 0;
+    me.nRunning = 0;
+
+    pthread_mutex_lock(&callLock);
+    pthread_mutex_lock(&lock);
+    startWorkers(me.nHelpers);
+    job = &me;
+    ++jobSeq;
+    pthread_cond_broadcast(&jobReady);
+    pthread_mutex_unlock(&lock);
+
+    hashChunks(&me);
+
+    pthread_mutex_lock(&lock);
+    while (me.nRunning != 0)
+    {
+        pthread_cond_wait(&jobDone, &lock);
+    }
+    job = (Job *)0;
+    pthread_mutex_unlock(&lock);
+    pthread_mutex_unlock(&callLock);
+
+    crc = stitch(&me);
+    free(me.crcs);
+    return crc;
+}
+
+void
+Crc32_setChunkSize(size_t nBytes)
+{
+    chunkSize = nBytes;
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -14,21 +14,68 @@
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  By default, every byte of the message is widened to a word of its own 
+ *  and the unit is fed with these words. The peripheral keeps the 
+ *  remainder between Crc32_update() calls, so only one context can be 
+ *  open at a time.
+ *
+ *  When CRC32_STM32_WORD_FED is defined, the unit is fed with the words 
+ *  of the message itself, straight from the caller's buffer, so it does 
+ *  a quarter of the work and nothing is copied. Bytes before the first 
+ *  aligned word and after the last one are calculated in software, from 
+ *  a 16-entry table. It requires the programmable CRC unit (INIT 
+ *  register, REV_IN and REV_OUT), which Crc32_init() configures to 
+ *  calculate the reflected CRC-32. So the results are the same as the 
+ *  ones of Crc32_sw.c, but not the same as the ones of the default 
+ *  mode: the blocks already stored must be sealed again when switching 
+ *  modes. The remainder is loaded into the unit on every 
+ *  Crc32_update(), so several contexts can be open at a time.
+ *
+ *  CRC32_STM32 must be defined for the whole build, so that the users of 
+ *  Crc32_ct.h know whether its CRCs match the ones of this unit.
+ */
+
 /* ----------------------------- Include files ----------------------------- */
 #include <string.h>
 #include "Crc32.h"
 #include "bsp.h"
 #include "crc.h"
+#include "rkhassert.h"
+#if defined(CRC32_STM32_WORD_FED)
+#include "Crc32_ct.h"
+#else
 #include "GStatus.h"
 #include "rfile.h"
 #include "Config.h"
-#include "rkhassert.h"
+#endif
 
 RKH_MODULE_NAME(Crc32)
 
+#if !defined(CRC32_STM32)
+#error "Crc32_stm32.c requires CRC32_STM32 to be defined for the whole build"
+#endif
+
 /* ----------------------------- Local macros ------------------------------ */
+#define NUM_BUFFER_WORDS    sizeof(SecBlock)
+
+#define CRC32_FIXED_DEFINE(n) \
+    Crc32 \
+    Crc32_calc##n(const uint8_t *message, Crc32 init) \
+    { \
+        return Crc32_calc(message, n, init); \
+    }
+
 /* ------------------------------- Constants ------------------------------- */
+#if defined(CRC32_STM32_WORD_FED)
+static const Crc32 crcNibbleTable[] =
+{
+    CRC32_CT_NIBBLE_TABLE
+};
+#endif
+
 /* ---------------------------- Local data types --------------------------- */
+#if !defined(CRC32_STM32_WORD_FED)
 typedef union SecBlock SecBlock;
 union SecBlock
 {
@@ -36,31 +83,151 @@ union SecBlock
     Config configData;
     GStatusType gStatusTypeData;
 };
+#endif
 
 /* ---------------------------- Global variables --------------------------- */
 /* ---------------------------- Local variables ---------------------------- */
-static uint32_t buffer[sizeof(SecBlock)];
+#if !defined(CRC32_STM32_WORD_FED)
+static uint32_t buffer[NUM_BUFFER_WORDS];
+#endif
 
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+#if defined(CRC32_STM32_WORD_FED)
+static Crc32
+updateBytes(Crc32 remainder, const uint8_t *message, size_t nBytes)
+{
+    for (; nBytes != 0; --nBytes, ++message)
+    {
+        remainder ^= *message;
+        remainder = crcNibbleTable[remainder & 0x0f] ^ (remainder >> 4);
+        remainder = crcNibbleTable[remainder & 0x0f] ^ (remainder >> 4);
+    }
+    return remainder;
+}
+#endif
+
 /* ---------------------------- Global functions --------------------------- */
 void
 Crc32_init(void)
 {
+#if defined(CRC32_STM32_WORD_FED)
+    hcrc.Init.DefaultPolynomialUse = DEFAULT_POLYNOMIAL_ENABLE;
+    hcrc.Init.DefaultInitValueUse = DEFAULT_INIT_VALUE_ENABLE;
+    hcrc.Init.InputDataInversionMode = CRC_INPUTDATA_INVERSION_WORD;
+    hcrc.Init.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_ENABLE;
+    hcrc.InputDataFormat = CRC_INPUTDATA_FORMAT_WORDS;
+    HAL_CRC_Init(&hcrc);
+#endif
 }
 
 Crc32
 Crc32_calc(const uint8_t *message, size_t nBytes, Crc32 init)
 {
-	size_t i;
+    Crc32Ctx ctx;
+
+    Crc32_begin(&ctx, init);
+    Crc32_update(&ctx, message, nBytes);
+    return Crc32_final(&ctx);
+}
+
+Crc32
+Crc32_copyCalc(uint8_t *dst, const uint8_t *src, size_t nBytes, Crc32 init)
+{
+    memcpy(dst, src, nBytes);
+    return Crc32_calc(dst, nBytes, init);
+}
+
+/*
+ *  The CRC unit takes a single stream, so the buffers are calculated one 
+ *  after the other.
+ */
+void
+Crc32_calcMulti(const uint8_t *bufs[], const size_t lens[], Crc32 out[], 
+                size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+    {
+        out[i] = Crc32_calc(bufs[i], lens[i], 0xffffffff);
+    }
+}
+
+#if defined(CRC32_STM32_WORD_FED)
+void
+Crc32_begin(Crc32Ctx *ctx, Crc32 init)
+{
+    ctx->remainder = CRC32_CT_REFLECT(init);
+}
 
-    RKH_REQUIRE(nBytes <= sizeof(SecBlock));
-	for (i = 0; i < nBytes; ++i, ++message)
+void
+Crc32_update(Crc32Ctx *ctx, const uint8_t *message, size_t nBytes)
+{
+    Crc32 remainder;
+    size_t nHead, nWords;
+
+    nHead = (size_t)(-(uintptr_t)message & 0x03);
+    nHead = (nHead < nBytes) ? nHead : nBytes;
+    remainder = updateBytes(ctx->remainder, message, nHead);
+    message += nHead;
+    nBytes -= nHead;
+
+    nWords = nBytes / sizeof(uint32_t);
+    if (nWords != 0)
     {
-		buffer[i] = *message;
+        hcrc.Instance->INIT = CRC32_CT_REFLECT(remainder);
+        __HAL_CRC_DR_RESET(&hcrc);
+        remainder = HAL_CRC_Accumulate(&hcrc, (uint32_t *)message, nWords);
+        message += nWords * sizeof(uint32_t);
     }
+    ctx->remainder = updateBytes(remainder, message, 
+                                 nBytes % sizeof(uint32_t));
+}
 
-	return HAL_CRC_Calculate(&hcrc, buffer, nBytes);
+Crc32
+Crc32_final(const Crc32Ctx *ctx)
+{
+    return ctx->remainder ^ CRC32_FINAL_XOR_VALUE;
 }
+#else
+void
+Crc32_begin(Crc32Ctx *ctx, Crc32 init)
+{
+    __HAL_CRC_DR_RESET(&hcrc);
+    ctx->remainder = hcrc.Instance->DR;
+}
+
+void
+Crc32_update(Crc32Ctx *ctx, const uint8_t *message, size_t nBytes)
+{
+	size_t i, nChunk;
+
+    for (; nBytes != 0; nBytes -= nChunk)
+    {
+        nChunk = (nBytes < NUM_BUFFER_WORDS) ? nBytes : NUM_BUFFER_WORDS;
+        for (i = 0; i < nChunk; ++i, ++message)
+        {
+            buffer[i] = *message;
+        }
+        ctx->remainder = HAL_CRC_Accumulate(&hcrc, buffer, nChunk);
+    }
+}
+
+Crc32
+Crc32_final(const Crc32Ctx *ctx)
+{
+    return ctx->remainder;
+}
+#endif
+
+CRC32_FIXED_DEFINE(4)
+CRC32_FIXED_DEFINE(8)
+CRC32_FIXED_DEFINE(12)
+CRC32_FIXED_DEFINE(16)
+CRC32_FIXED_DEFINE(20)
+CRC32_FIXED_DEFINE(24)
+CRC32_FIXED_DEFINE(28)
+CRC32_FIXED_DEFINE(32)
 
 /* ------------------------------ End of file ------------------------------ */
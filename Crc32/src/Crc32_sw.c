@@ -13,195 +13,429 @@
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  The kernel is selected at compile time by means of CRC32_KERNEL:
+ *
+ *  CRC32_KERNEL_NIBBLE     16-entry table, 4 bits per step. It takes 64 
+ *                          bytes of ROM and no RAM at all.
+ *  CRC32_KERNEL_BYTE       256-entry table, one byte per step (default).
+ *  CRC32_KERNEL_SLICE8     Slicing-by-8, 8 bytes per step. Its tables 
+ *                          take 7 KB of ROM.
+ *  CRC32_KERNEL_SLICE16    Slicing-by-16, 16 bytes per step. Its tables 
+ *                          take 15 KB of ROM.
+ *
+ *  Every table is generated at compile time from CRC32_POLYNOMIAL by 
+ *  Crc32_ct.h.
+ *
+ *  Every kernel works on the reflected (LSB-first) remainder, so neither 
+ *  input bytes nor the remainder are reflected bit by bit anymore. Only 
+ *  the init value is reflected, once per call, to keep the meaning of the 
+ *  init argument of Crc32_calc().
+ *
+ *  Crc32_calc4() ... Crc32_calc32() are generated by CRC32_FIXED_DEFINE() 
+ *  as straight-line code, without loop nor length checks.
+ *
+ *  Crc32_copyCalc() copies the message in chunks of COPY_CHUNK bytes and 
+ *  calculates the CRC of each chunk from the copy, while it is still in 
+ *  the L1 cache, so the source, e.g. a memory-mapped flash, is read once.
+ *
+ *  Crc32_calcMulti() runs MULTI_LANES independent CRCs interleaved, one 
+ *  step of each in turn, so that the table lookups of a stream are done 
+ *  while the ones of the others are still in flight. The step takes 8 
+ *  bytes with the slicing kernels and 4 bytes otherwise. A short group 
+ *  is padded with dummy streams over its first buffer.
+ *
+ *  On x86-64 hosts, Crc32_init() also checks the CPU and, when it 
+ *  supports PCLMULQDQ, messages of CRC32_CLMUL_THRESHOLD bytes or more 
+ *  are folded by Crc32_clmul.c. The selected kernel handles the rest.
+ */
+
 /* ----------------------------- Include files ----------------------------- */
-#include <stdio.h>
+#include <string.h>
 #include "Crc32.h"
+#include "Crc32_ct.h"
+#include "Crc32_clmul.h"
 
 /* ----------------------------- Local macros ------------------------------ */
-#define POLYNOMIAL			    0x04C11DB7
-#define INITIAL_REMAINDER	    0xFFFFFFFF
-#define FINAL_XOR_VALUE		    0xFFFFFFFF
+#define POLYNOMIAL			    CRC32_POLYNOMIAL
+#define INITIAL_REMAINDER	    CRC32_INITIAL_REMAINDER
+#define FINAL_XOR_VALUE		    CRC32_FINAL_XOR_VALUE
 #define REFLECT_DATA		    1
 #define REFLECT_REMAINDER	    1
 #define CHECK_VALUE			    0xCBF43926
 #define WIDTH                   (8 * sizeof(Crc32))
-#define TOPBIT                  (1 << (WIDTH - 1))
 
-#if (REFLECT_DATA == 1)
-#undef  REFLECT_DATA
-#define REFLECT_DATA(X)			((uint8_t)reflect((X), 8))
+#define CRC32_KERNEL_NIBBLE     0
+#define CRC32_KERNEL_BYTE       1
+#define CRC32_KERNEL_SLICE8     2
+#define CRC32_KERNEL_SLICE16    3
+
+#ifndef CRC32_KERNEL
+#define CRC32_KERNEL            CRC32_KERNEL_BYTE
+#endif
+
+#if (REFLECT_DATA != 1) || (REFLECT_REMAINDER != 1)
+#error "Crc32_sw.c kernels only support reflected CRC-32 parameters"
+#endif
+
+#if (CRC32_KERNEL == CRC32_KERNEL_SLICE16)
+#define NUM_SLICES              16
+#elif (CRC32_KERNEL == CRC32_KERNEL_SLICE8)
+#define NUM_SLICES              8
+#elif (CRC32_KERNEL == CRC32_KERNEL_BYTE)
+#define update                  updateBytes
+#endif
+
+#define COPY_CHUNK              256
+#define MULTI_LANES             4
+
+#define LOAD32(p)               ((Crc32)(p)[0] | \
+                                 ((Crc32)(p)[1] << 8) | \
+                                 ((Crc32)(p)[2] << 16) | \
+                                 ((Crc32)(p)[3] << 24))
+
+/*
+ *  Folds the 4 bytes at p into the remainder r. It takes a whole word by 
+ *  means of the slicing tables, when they are available.
+ */
+#if defined(NUM_SLICES)
+#define STEP4(r, p)             r ^= LOAD32(p); \
+                                r = sliceTable[2][r & 0xff] ^ \
+                                    sliceTable[1][(r >> 8) & 0xff] ^ \
+                                    sliceTable[0][(r >> 16) & 0xff] ^ \
+                                    crcTable[r >> 24];
+#elif (CRC32_KERNEL == CRC32_KERNEL_BYTE)
+#define BYTE_STEP(r, b)         r = crcTable[(r ^ (b)) & 0xff] ^ (r >> 8);
+#define STEP4(r, p)             BYTE_STEP(r, (p)[0]) BYTE_STEP(r, (p)[1]) \
+                                BYTE_STEP(r, (p)[2]) BYTE_STEP(r, (p)[3])
 #else
-#undef  REFLECT_DATA
-#define REFLECT_DATA(X)			(X)
+#define NIBBLE_STEP(r)          r = crcNibbleTable[r & 0x0f] ^ (r >> 4);
+#define STEP4(r, p)             r ^= LOAD32(p); \
+                                NIBBLE_STEP(r) NIBBLE_STEP(r) \
+                                NIBBLE_STEP(r) NIBBLE_STEP(r) \
+                                NIBBLE_STEP(r) NIBBLE_STEP(r) \
+                                NIBBLE_STEP(r) NIBBLE_STEP(r)
 #endif
 
-#if (REFLECT_REMAINDER == 1)
-#undef  REFLECT_REMAINDER
-#define REFLECT_REMAINDER(X)	((Crc32)reflect((X), WIDTH))
+#define FIXED_STEP(o)           STEP4(remainder, message + (o))
+
+/* Interleaved step of Crc32_calcMulti() */
+#if defined(NUM_SLICES)
+#define MULTI_STEP_LEN          8
+#define MULTI_STEP(r, p)        r ^= LOAD32(p); \
+                                r = sliceTable[6][r & 0xff] ^ \
+                                    sliceTable[5][(r >> 8) & 0xff] ^ \
+                                    sliceTable[4][(r >> 16) & 0xff] ^ \
+                                    sliceTable[3][r >> 24] ^ \
+                                    sliceTable[2][(p)[4]] ^ \
+                                    sliceTable[1][(p)[5]] ^ \
+                                    sliceTable[0][(p)[6]] ^ \
+                                    crcTable[(p)[7]];
 #else
-#undef  REFLECT_REMAINDER
-#define REFLECT_REMAINDER(X)	(X)
+#define MULTI_STEP_LEN          4
+#define MULTI_STEP(r, p)        STEP4(r, p)
 #endif
 
+#define FIXED_STEPS_4           FIXED_STEP(0)
+#define FIXED_STEPS_8           FIXED_STEPS_4 FIXED_STEP(4)
+#define FIXED_STEPS_12          FIXED_STEPS_8 FIXED_STEP(8)
+#define FIXED_STEPS_16          FIXED_STEPS_12 FIXED_STEP(12)
+#define FIXED_STEPS_20          FIXED_STEPS_16 FIXED_STEP(16)
+#define FIXED_STEPS_24          FIXED_STEPS_20 FIXED_STEP(20)
+#define FIXED_STEPS_28          FIXED_STEPS_24 FIXED_STEP(24)
+#define FIXED_STEPS_32          FIXED_STEPS_28 FIXED_STEP(28)
+
+#define CRC32_FIXED_DEFINE(n) \
+    Crc32 \
+    Crc32_calc##n(const uint8_t *message, Crc32 init) \
+    { \
+        Crc32 remainder; \
+        \
+        remainder = reflect(init); \
+        FIXED_STEPS_##n \
+        return remainder ^ FINAL_XOR_VALUE; \
+    }
+
 /* ------------------------------- Constants ------------------------------- */
+#if (CRC32_KERNEL == CRC32_KERNEL_NIBBLE)
+static const Crc32 crcNibbleTable[] =
+{
+    CRC32_CT_NIBBLE_TABLE
+};
+#else
 static const Crc32 crcTable[] =
 {
-    0x00000000, 0x04c11db7, 0x09823b6e, 0x0d4326d9,
-    0x130476dc, 0x17c56b6b, 0x1a864db2, 0x1e475005,
-    0x2608edb8, 0x22c9f00f, 0x2f8ad6d6, 0x2b4bcb61,
-    0x350c9b64, 0x31cd86d3, 0x3c8ea00a, 0x384fbdbd,
-    0x4c11db70, 0x48d0c6c7, 0x4593e01e, 0x4152fda9,
-    0x5f15adac, 0x5bd4b01b, 0x569796c2, 0x52568b75,
-    0x6a1936c8, 0x6ed82b7f, 0x639b0da6, 0x675a1011,
-    0x791d4014, 0x7ddc5da3, 0x709f7b7a, 0x745e66cd,
-    0x9823b6e0, 0x9ce2ab57, 0x91a18d8e, 0x95609039,
-    0x8b27c03c, 0x8fe6dd8b, 0x82a5fb52, 0x8664e6e5,
-    0xbe2b5b58, 0xbaea46ef, 0xb7a96036, 0xb3687d81,
-    0xad2f2d84, 0xa9ee3033, 0xa4ad16ea, 0xa06c0b5d,
-    0xd4326d90, 0xd0f37027, 0xddb056fe, 0xd9714b49,
-    0xc7361b4c, 0xc3f706fb, 0xceb42022, 0xca753d95,
-    0xf23a8028, 0xf6fb9d9f, 0xfbb8bb46, 0xff79a6f1,
-    0xe13ef6f4, 0xe5ffeb43, 0xe8bccd9a, 0xec7dd02d,
-    0x34867077, 0x30476dc0, 0x3d044b19, 0x39c556ae,
-    0x278206ab, 0x23431b1c, 0x2e003dc5, 0x2ac12072,
-    0x128e9dcf, 0x164f8078, 0x1b0ca6a1, 0x1fcdbb16,
-    0x018aeb13, 0x054bf6a4, 0x0808d07d, 0x0cc9cdca,
-    0x7897ab07, 0x7c56b6b0, 0x71159069, 0x75d48dde,
-    0x6b93dddb, 0x6f52c06c, 0x6211e6b5, 0x66d0fb02,
-    0x5e9f46bf, 0x5a5e5b08, 0x571d7dd1, 0x53dc6066,
-    0x4d9b3063, 0x495a2dd4, 0x44190b0d, 0x40d816ba,
-    0xaca5c697, 0xa864db20, 0xa527fdf9, 0xa1e6e04e,
-    0xbfa1b04b, 0xbb60adfc, 0xb6238b25, 0xb2e29692,
-    0x8aad2b2f, 0x8e6c3698, 0x832f1041, 0x87ee0df6,
-    0x99a95df3, 0x9d684044, 0x902b669d, 0x94ea7b2a,
-    0xe0b41de7, 0xe4750050, 0xe9362689, 0xedf73b3e,
-    0xf3b06b3b, 0xf771768c, 0xfa325055, 0xfef34de2,
-    0xc6bcf05f, 0xc27dede8, 0xcf3ecb31, 0xcbffd686,
-    0xd5b88683, 0xd1799b34, 0xdc3abded, 0xd8fba05a,
-    0x690ce0ee, 0x6dcdfd59, 0x608edb80, 0x644fc637,
-    0x7a089632, 0x7ec98b85, 0x738aad5c, 0x774bb0eb,
-    0x4f040d56, 0x4bc510e1, 0x46863638, 0x42472b8f,
-    0x5c007b8a, 0x58c1663d, 0x558240e4, 0x51435d53,
-    0x251d3b9e, 0x21dc2629, 0x2c9f00f0, 0x285e1d47,
-    0x36194d42, 0x32d850f5, 0x3f9b762c, 0x3b5a6b9b,
-    0x0315d626, 0x07d4cb91, 0x0a97ed48, 0x0e56f0ff,
-    0x1011a0fa, 0x14d0bd4d, 0x19939b94, 0x1d528623,
-    0xf12f560e, 0xf5ee4bb9, 0xf8ad6d60, 0xfc6c70d7,
-    0xe22b20d2, 0xe6ea3d65, 0xeba91bbc, 0xef68060b,
-    0xd727bbb6, 0xd3e6a601, 0xdea580d8, 0xda649d6f,
-    0xc423cd6a, 0xc0e2d0dd, 0xcda1f604, 0xc960ebb3,
-    0xbd3e8d7e, 0xb9ff90c9, 0xb4bcb610, 0xb07daba7,
-    0xae3afba2, 0xaafbe615, 0xa7b8c0cc, 0xa379dd7b,
-    0x9b3660c6, 0x9ff77d71, 0x92b45ba8, 0x9675461f,
-    0x8832161a, 0x8cf30bad, 0x81b02d74, 0x857130c3,
-    0x5d8a9099, 0x594b8d2e, 0x5408abf7, 0x50c9b640,
-    0x4e8ee645, 0x4a4ffbf2, 0x470cdd2b, 0x43cdc09c,
-    0x7b827d21, 0x7f436096, 0x7200464f, 0x76c15bf8,
-    0x68860bfd, 0x6c47164a, 0x61043093, 0x65c52d24,
-    0x119b4be9, 0x155a565e, 0x18197087, 0x1cd86d30,
-    0x029f3d35, 0x065e2082, 0x0b1d065b, 0x0fdc1bec,
-    0x3793a651, 0x3352bbe6, 0x3e119d3f, 0x3ad08088,
-    0x2497d08d, 0x2056cd3a, 0x2d15ebe3, 0x29d4f654,
-    0xc5a92679, 0xc1683bce, 0xcc2b1d17, 0xc8ea00a0,
-    0xd6ad50a5, 0xd26c4d12, 0xdf2f6bcb, 0xdbee767c,
-    0xe3a1cbc1, 0xe760d676, 0xea23f0af, 0xeee2ed18,
-    0xf0a5bd1d, 0xf464a0aa, 0xf9278673, 0xfde69bc4,
-    0x89b8fd09, 0x8d79e0be, 0x803ac667, 0x84fbdbd0,
-    0x9abc8bd5, 0x9e7d9662, 0x933eb0bb, 0x97ffad0c,
-    0xafb010b1, 0xab710d06, 0xa6322bdf, 0xa2f33668,
-    0xbcb4666d, 0xb8757bda, 0xb5365d03, 0xb1f740b4
+    CRC32_CT_TABLE(0)
 };
+#endif
+
+#if defined(NUM_SLICES)
+/* Slice 0 is crcTable itself */
+static const Crc32 sliceTable[NUM_SLICES - 1][256] =
+{
+    {CRC32_CT_TABLE(1)}, {CRC32_CT_TABLE(2)}, {CRC32_CT_TABLE(3)}, 
+    {CRC32_CT_TABLE(4)}, {CRC32_CT_TABLE(5)}, {CRC32_CT_TABLE(6)}, 
+    {CRC32_CT_TABLE(7)}, 
+#if (NUM_SLICES == 16)
+    {CRC32_CT_TABLE(8)}, {CRC32_CT_TABLE(9)}, {CRC32_CT_TABLE(10)}, 
+    {CRC32_CT_TABLE(11)}, {CRC32_CT_TABLE(12)}, {CRC32_CT_TABLE(13)}, 
+    {CRC32_CT_TABLE(14)}, {CRC32_CT_TABLE(15)}
+#endif
+};
+#endif
 
 /* ---------------------------- Local data types --------------------------- */
 /* ---------------------------- Global variables --------------------------- */
 /* ---------------------------- Local variables ---------------------------- */
+
 /* ----------------------- Local function prototypes ----------------------- */
+static Crc32 update(Crc32 remainder, const uint8_t *message, size_t nBytes);
+
+#if CRC32_CLMUL == 1
+static Crc32 (*kernel)(Crc32 remainder, const uint8_t *message, 
+                       size_t nBytes) = update;
+#else
+#define kernel                  update
+#endif
+
 /* ---------------------------- Local functions ---------------------------- */
 static Crc32
-reflect(Crc32 data, uint8_t nBits)
-{
-	Crc32 reflection = 0;
-	uint8_t bit;
-
-	for (bit = 0; bit < nBits; ++bit)
-	{
-		if (data & 0x01)
-		{
-			reflection |= (1 << ((nBits - 1) - bit));
-		}
-		data = (data >> 1);
-	}
-	return reflection;
+reflect(Crc32 data)
+{
+    data = ((data >> 1) & 0x55555555) | ((data & 0x55555555) << 1);
+    data = ((data >> 2) & 0x33333333) | ((data & 0x33333333) << 2);
+    data = ((data >> 4) & 0x0f0f0f0f) | ((data & 0x0f0f0f0f) << 4);
+    data = ((data >> 8) & 0x00ff00ff) | ((data & 0x00ff00ff) << 8);
+    return (data >> 16) | (data << 16);
 }
 
-/* ---------------------------- Global functions --------------------------- */
-void
-Crc32_init(void)
+#if (CRC32_KERNEL == CRC32_KERNEL_NIBBLE)
+static Crc32
+update(Crc32 remainder, const uint8_t *message, size_t nBytes)
 {
-#if 0
-    Crc32 remainder;
+    for (; nBytes != 0; --nBytes, ++message)
+    {
+        remainder ^= *message;
+        remainder = crcNibbleTable[remainder & 0x0f] ^ (remainder >> 4);
+        remainder = crcNibbleTable[remainder & 0x0f] ^ (remainder >> 4);
+    }
+    return remainder;
+}
+#else
+static Crc32
+updateBytes(Crc32 remainder, const uint8_t *message, size_t nBytes)
+{
+    for (; nBytes != 0; --nBytes, ++message)
+    {
+        remainder = crcTable[(remainder ^ *message) & 0xff] ^ 
+                    (remainder >> 8);
+    }
+    return remainder;
+}
+#endif
 
-    /* Compute the remainder of each possible dividend */
-    for (int dividend = 0; dividend < 256; ++dividend)
+#if (CRC32_KERNEL == CRC32_KERNEL_SLICE8)
+static Crc32
+update(Crc32 remainder, const uint8_t *message, size_t nBytes)
+{
+    Crc32 high;
+
+    for (; nBytes >= 8; nBytes -= 8, message += 8)
     {
-        /* Start with the dividend followed by zeros */
-        remainder = dividend << (WIDTH - 8);
+        remainder ^= LOAD32(message);
+        high = LOAD32(message + 4);
+        remainder = sliceTable[6][remainder & 0xff] ^
+                    sliceTable[5][(remainder >> 8) & 0xff] ^
+                    sliceTable[4][(remainder >> 16) & 0xff] ^
+                    sliceTable[3][remainder >> 24] ^
+                    sliceTable[2][high & 0xff] ^
+                    sliceTable[1][(high >> 8) & 0xff] ^
+                    sliceTable[0][(high >> 16) & 0xff] ^
+                    crcTable[high >> 24];
+    }
+    return updateBytes(remainder, message, nBytes);
+}
+#endif
 
-        /* Perform modulo-2 division, a bit at a time */
-        for (uint8_t bit = 8; bit > 0; --bit)
-        {
-            /* Try to divide the current data bit */
-            if (remainder & TOPBIT)
-            {
-                remainder = (remainder << 1) ^ POLYNOMIAL;
-            }
-            else
-            {
-                remainder = (remainder << 1);
-            }
-        }
+#if (CRC32_KERNEL == CRC32_KERNEL_SLICE16)
+static Crc32
+update(Crc32 remainder, const uint8_t *message, size_t nBytes)
+{
+    Crc32 w1, w2, w3;
 
-        /* Store the result into the table */
-        crcTable[dividend] = remainder;
+    for (; nBytes >= 16; nBytes -= 16, message += 16)
+    {
+        remainder ^= LOAD32(message);
+        w1 = LOAD32(message + 4);
+        w2 = LOAD32(message + 8);
+        w3 = LOAD32(message + 12);
+        remainder = sliceTable[14][remainder & 0xff] ^
+                    sliceTable[13][(remainder >> 8) & 0xff] ^
+                    sliceTable[12][(remainder >> 16) & 0xff] ^
+                    sliceTable[11][remainder >> 24] ^
+                    sliceTable[10][w1 & 0xff] ^
+                    sliceTable[9][(w1 >> 8) & 0xff] ^
+                    sliceTable[8][(w1 >> 16) & 0xff] ^
+                    sliceTable[7][w1 >> 24] ^
+                    sliceTable[6][w2 & 0xff] ^
+                    sliceTable[5][(w2 >> 8) & 0xff] ^
+                    sliceTable[4][(w2 >> 16) & 0xff] ^
+                    sliceTable[3][w2 >> 24] ^
+                    sliceTable[2][w3 & 0xff] ^
+                    sliceTable[1][(w3 >> 8) & 0xff] ^
+                    sliceTable[0][(w3 >> 16) & 0xff] ^
+                    crcTable[w3 >> 24];
     }
+    return updateBytes(remainder, message, nBytes);
+}
+#endif
 
-    FILE *file;
+#if CRC32_CLMUL == 1
+static Crc32
+updateClmul(Crc32 remainder, const uint8_t *message, size_t nBytes)
+{
+    size_t nFold;
 
-    if ((file = fopen("table", "w+")) != NULL)
+    if (nBytes >= CRC32_CLMUL_THRESHOLD)
     {
-        fprintf(file, "static const Crc32 crcTable[] = \n{\n");
-        for (int i = 0; i < 256/4; ++i)
-        {
-            fputs("    ", file);
-            for (int j = 0; j < 4; ++j)
-            {
-                fprintf(file, "0x%08x, ", crcTable[j + (i * 4)]);
-            }
-            fprintf(file, "\n");
-        }
-        fprintf(file, "}\n");
+        nFold = nBytes & ~(size_t)15;
+        remainder = Crc32_clmulFold(remainder, message, nFold);
+        message += nFold;
+        nBytes -= nFold;
+    }
+    return update(remainder, message, nBytes);
+}
+#endif
+
+/*
+ *  Returns the number of bytes, a multiple of 4, that the streams of a 
+ *  group of Crc32_calcMulti() take interleaved. The rest of each one is 
+ *  taken by the selected kernel.
+ */
+static size_t
+interleavedLen(const size_t lens[], size_t nLanes)
+{
+    size_t len;
+
+    for (len = lens[--nLanes]; nLanes != 0; )
+    {
+        --nLanes;
+        len = (lens[nLanes] < len) ? lens[nLanes] : len;
     }
-    else
+#if CRC32_CLMUL == 1
+    if ((kernel == updateClmul) && (len >= CRC32_CLMUL_THRESHOLD))
     {
-        printf("Can not open file\n");
+        return 0;
     }
+#endif
+    return len - (len % MULTI_STEP_LEN);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+Crc32_init(void)
+{
+#if CRC32_CLMUL == 1
+    kernel = Crc32_clmulAvailable() ? updateClmul : update;
 #endif
 }
 
 Crc32
 Crc32_calc(const uint8_t *message, size_t nBytes, Crc32 init)
 {
-    uint8_t data;
-    int byte;
+    Crc32Ctx ctx;
+
+    Crc32_begin(&ctx, init);
+    Crc32_update(&ctx, message, nBytes);
+    return Crc32_final(&ctx);
+}
+
+Crc32
+Crc32_copyCalc(uint8_t *dst, const uint8_t *src, size_t nBytes, Crc32 init)
+{
     Crc32 remainder;
+    size_t chunk;
+
+    remainder = reflect(init);
+    for (; nBytes != 0; nBytes -= chunk, src += chunk, dst += chunk)
+    {
+        chunk = (nBytes < COPY_CHUNK) ? nBytes : COPY_CHUNK;
+        memcpy(dst, src, chunk);
+        remainder = kernel(remainder, dst, chunk);
+    }
+    return remainder ^ FINAL_XOR_VALUE;
+}
+
+void
+Crc32_calcMulti(const uint8_t *bufs[], const size_t lens[], Crc32 out[], 
+                size_t n)
+{
+    const uint8_t *p[MULTI_LANES];
+    Crc32 r0, r1, r2, r3;
+    size_t i, k, nLanes, len, offset;
 
-    for (remainder = init, byte = 0; byte < nBytes; ++byte)
+    for (i = 0; i < n; i += nLanes)
     {
-        data = REFLECT_DATA(message[byte]) ^ (remainder >> (WIDTH - 8));
-  		remainder = crcTable[data] ^ (remainder << 8);
+        nLanes = ((n - i) < MULTI_LANES) ? (n - i) : MULTI_LANES;
+        for (k = 0; k < MULTI_LANES; ++k)
+        {
+            p[k] = bufs[i + ((k < nLanes) ? k : 0)];
+        }
+
+        len = interleavedLen(&lens[i], nLanes);
+        r0 = r1 = r2 = r3 = INITIAL_REMAINDER;
+        for (offset = 0; offset < len; offset += MULTI_STEP_LEN)
+        {
+            MULTI_STEP(r0, p[0] + offset)
+            MULTI_STEP(r1, p[1] + offset)
+            MULTI_STEP(r2, p[2] + offset)
+            MULTI_STEP(r3, p[3] + offset)
+        }
+
+        out[i] = kernel(r0, p[0] + len, lens[i] - len) ^ FINAL_XOR_VALUE;
+        if (nLanes > 1)
+        {
+            out[i + 1] = kernel(r1, p[1] + len, lens[i + 1] - len) ^ 
+                         FINAL_XOR_VALUE;
+        }
+        if (nLanes > 2)
+        {
+            out[i + 2] = kernel(r2, p[2] + len, lens[i + 2] - len) ^ 
+                         FINAL_XOR_VALUE;
+        }
+        if (nLanes > 3)
+        {
+            out[i + 3] = kernel(r3, p[3] + len, lens[i + 3] - len) ^ 
+                         FINAL_XOR_VALUE;
+        }
     }
+}
+
+void
+Crc32_begin(Crc32Ctx *ctx, Crc32 init)
+{
+    ctx->remainder = reflect(init);
+}
 
-    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
+void
+Crc32_update(Crc32Ctx *ctx, const uint8_t *message, size_t nBytes)
+{
+    ctx->remainder = kernel(ctx->remainder, message, nBytes);
 }
 
+Crc32
+Crc32_final(const Crc32Ctx *ctx)
+{
+    return ctx->remainder ^ FINAL_XOR_VALUE;
+}
+
+CRC32_FIXED_DEFINE(4)
+CRC32_FIXED_DEFINE(8)
+CRC32_FIXED_DEFINE(12)
+CRC32_FIXED_DEFINE(16)
+CRC32_FIXED_DEFINE(20)
+CRC32_FIXED_DEFINE(24)
+CRC32_FIXED_DEFINE(28)
+CRC32_FIXED_DEFINE(32)
+
 /* ------------------------------ End of file ------------------------------ */
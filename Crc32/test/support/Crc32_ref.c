@@ -0,0 +1,62 @@
+/**
+ *  \file       Crc32_ref.c
+ *  \brief      Bit-by-bit CRC-32 reference for the kernel tests.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/* ----------------------------- Include files ----------------------------- */
+#include "Crc32_ref.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define POLYNOMIAL          0x04c11db7
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static uint32_t
+reflect(uint32_t data, int nBits)
+{
+    uint32_t reflection = 0;
+    int bit;
+
+    for (bit = 0; bit < nBits; ++bit, data >>= 1)
+    {
+        if (data & 0x01)
+        {
+            reflection |= (uint32_t)1 << ((nBits - 1) - bit);
+        }
+    }
+    return reflection;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+uint32_t
+Crc32Ref_calc(const uint8_t *buf, size_t len, uint32_t remainder)
+{
+    int bit;
+
+    for (; len != 0; --len, ++buf)
+    {
+        remainder ^= reflect(*buf, 8) << 24;
+        for (bit = 0; bit < 8; ++bit)
+        {
+            remainder = (remainder & 0x80000000) ? 
+                        (remainder << 1) ^ POLYNOMIAL : (remainder << 1);
+        }
+    }
+    return reflect(remainder, 32) ^ 0xffffffff;
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,50 @@
+/**
+ *  \file       Crc32_ref.h
+ *  \brief      Bit-by-bit CRC-32 reference for the kernel tests.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  Crc32Ref_calc() is the MSB-first shift register the table-driven 
+ *  kernels of Crc32_sw.c must be equivalent to, for any init value. It 
+ *  takes the same arguments and returns the same value as Crc32_calc().
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __CRC32_REF_H__
+#define __CRC32_REF_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+/* -------------------------------- Constants ------------------------------ */
+/* ------------------------------- Data types ------------------------------ */
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+uint32_t Crc32Ref_calc(const uint8_t *buf, size_t len, uint32_t init);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,13 @@
+/**
+ *  \file       bsp.h
+ *  \brief      Empty board support for host builds.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __BSP_H__
+#define __BSP_H__
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,147 @@
+/**
+ *  \file       crc.c
+ *  \brief      Host-side simulator of the STM32 CRC peripheral and HAL.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The unit keeps its remainder in 'reg', MSB-first as the real one does. 
+ *  Every word written to DR is bit-reversed as selected by REV_IN, XORed 
+ *  into reg and shifted out over the polynomial bit by bit. Reading DR 
+ *  gives reg, bit-reversed when REV_OUT is set.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include "crc.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+CRC_HandleTypeDef hcrc;
+uint32_t CrcSim_nWrites;
+
+/* ---------------------------- Local variables ---------------------------- */
+static CRC_TypeDef crcUnit;
+static uint32_t reg;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static uint32_t
+reverseBytes(uint32_t data)
+{
+    data = ((data >> 1) & 0x55555555) | ((data & 0x55555555) << 1);
+    data = ((data >> 2) & 0x33333333) | ((data & 0x33333333) << 2);
+    return ((data >> 4) & 0x0f0f0f0f) | ((data & 0x0f0f0f0f) << 4);
+}
+
+static uint32_t
+reverse(uint32_t data, uint32_t mode)
+{
+    switch (mode)
+    {
+        case CRC_INPUTDATA_INVERSION_BYTE:
+            return reverseBytes(data);
+        case CRC_INPUTDATA_INVERSION_HALFWORD:
+            data = reverseBytes(data);
+            return ((data >> 8) & 0x00ff00ff) | ((data & 0x00ff00ff) << 8);
+        case CRC_INPUTDATA_INVERSION_WORD:
+            data = reverseBytes(data);
+            data = ((data >> 8) & 0x00ff00ff) | ((data & 0x00ff00ff) << 8);
+            return (data >> 16) | (data << 16);
+        default:
+            return data;
+    }
+}
+
+static void
+updateDR(void)
+{
+    crcUnit.DR = ((crcUnit.CR & CRC_CR_REV_OUT) != 0) ?
+                 reverse(reg, CRC_INPUTDATA_INVERSION_WORD) : reg;
+}
+
+static void
+writeDR(uint32_t data)
+{
+    int bit;
+
+    reg ^= reverse(data, crcUnit.CR & CRC_CR_REV_IN);
+    for (bit = 0; bit < 32; ++bit)
+    {
+        reg = (reg & 0x80000000) ? (reg << 1) ^ crcUnit.POL : (reg << 1);
+    }
+    ++CrcSim_nWrites;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+MX_CRC_Init(void)
+{
+    hcrc.Instance = &crcUnit;
+    hcrc.Init.DefaultPolynomialUse = DEFAULT_POLYNOMIAL_ENABLE;
+    hcrc.Init.DefaultInitValueUse = DEFAULT_INIT_VALUE_ENABLE;
+    hcrc.Init.InputDataInversionMode = CRC_INPUTDATA_INVERSION_NONE;
+    hcrc.Init.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_DISABLE;
+    hcrc.InputDataFormat = CRC_INPUTDATA_FORMAT_WORDS;
+    HAL_CRC_Init(&hcrc);
+}
+
+HAL_StatusTypeDef
+HAL_CRC_Init(CRC_HandleTypeDef *h)
+{
+    if ((h == (CRC_HandleTypeDef *)0) || (h->Instance != &crcUnit))
+    {
+        return HAL_ERROR;
+    }
+    crcUnit.POL = (h->Init.DefaultPolynomialUse == DEFAULT_POLYNOMIAL_ENABLE) ?
+                  DEFAULT_CRC32_POLY : h->Init.GeneratingPolynomial;
+    crcUnit.INIT = (h->Init.DefaultInitValueUse == DEFAULT_INIT_VALUE_ENABLE) ?
+                   DEFAULT_CRC_INITVALUE : h->Init.InitValue;
+    crcUnit.CR = h->Init.InputDataInversionMode | 
+                 h->Init.OutputDataInversionMode;
+    CrcSim_reset(h);
+    return HAL_OK;
+}
+
+uint32_t
+HAL_CRC_Accumulate(CRC_HandleTypeDef *h, uint32_t pBuffer[], 
+                   uint32_t BufferLength)
+{
+    uint32_t i;
+
+    (void)h;
+    for (i = 0; i < BufferLength; ++i)
+    {
+        writeDR(pBuffer[i]);
+    }
+    updateDR();
+    return crcUnit.DR;
+}
+
+uint32_t
+HAL_CRC_Calculate(CRC_HandleTypeDef *h, uint32_t pBuffer[], 
+                  uint32_t BufferLength)
+{
+    CrcSim_reset(h);
+    return HAL_CRC_Accumulate(h, pBuffer, BufferLength);
+}
+
+void
+CrcSim_reset(CRC_HandleTypeDef *h)
+{
+    (void)h;
+    reg = crcUnit.INIT;
+    updateDR();
+}
+
+/* ------------------------------ End of file ------------------------------ */
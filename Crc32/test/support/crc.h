@@ -0,0 +1,121 @@
+/**
+ *  \file       crc.h
+ *  \brief      Host-side stand-in of the STM32 CRC peripheral and HAL.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It replaces the crc.h generated by CubeMX and the subset of the HAL 
+ *  used by Crc32_stm32.c, so that it can be tested and benchmarked on 
+ *  the host. The simulated unit is the programmable one (INIT register, 
+ *  REV_IN and REV_OUT), 32-bit polynomial only.
+ *
+ *  Registers are plain memory, so the side effects of writing DR and the 
+ *  RESET bit of CR take place in HAL_CRC_Accumulate(), 
+ *  HAL_CRC_Calculate() and __HAL_CRC_DR_RESET(). CrcSim_nWrites counts 
+ *  the data writes to DR, for the tests to check how the unit is fed.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __CRC_H__
+#define __CRC_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdint.h>
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#define CRC_CR_RESET                        0x00000001
+#define CRC_CR_REV_IN                       0x00000060
+#define CRC_CR_REV_OUT                      0x00000080
+
+#define __HAL_CRC_DR_RESET(h)               CrcSim_reset(h)
+
+/* -------------------------------- Constants ------------------------------ */
+#define DEFAULT_POLYNOMIAL_ENABLE           ((uint8_t)0x00)
+#define DEFAULT_POLYNOMIAL_DISABLE          ((uint8_t)0x01)
+#define DEFAULT_INIT_VALUE_ENABLE           ((uint8_t)0x00)
+#define DEFAULT_INIT_VALUE_DISABLE          ((uint8_t)0x01)
+#define DEFAULT_CRC32_POLY                  0x04C11DB7
+#define DEFAULT_CRC_INITVALUE               0xFFFFFFFF
+#define CRC_POLYLENGTH_32B                  0x00000000
+
+#define CRC_INPUTDATA_INVERSION_NONE        0x00000000
+#define CRC_INPUTDATA_INVERSION_BYTE        0x00000020
+#define CRC_INPUTDATA_INVERSION_HALFWORD    0x00000040
+#define CRC_INPUTDATA_INVERSION_WORD        0x00000060
+#define CRC_OUTPUTDATA_INVERSION_DISABLE    0x00000000
+#define CRC_OUTPUTDATA_INVERSION_ENABLE     0x00000080
+
+#define CRC_INPUTDATA_FORMAT_WORDS          0x00000003
+
+/* ------------------------------- Data types ------------------------------ */
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR = 1
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+    volatile uint32_t DR;
+    volatile uint32_t IDR;
+    volatile uint32_t CR;
+    uint32_t RESERVED2;
+    volatile uint32_t INIT;
+    volatile uint32_t POL;
+} CRC_TypeDef;
+
+typedef struct
+{
+    uint8_t DefaultPolynomialUse;
+    uint8_t DefaultInitValueUse;
+    uint32_t GeneratingPolynomial;
+    uint32_t CRCLength;
+    uint32_t InitValue;
+    uint32_t InputDataInversionMode;
+    uint32_t OutputDataInversionMode;
+} CRC_InitTypeDef;
+
+typedef struct
+{
+    CRC_TypeDef *Instance;
+    CRC_InitTypeDef Init;
+    uint32_t InputDataFormat;
+} CRC_HandleTypeDef;
+
+/* -------------------------- External variables --------------------------- */
+extern CRC_HandleTypeDef hcrc;
+extern uint32_t CrcSim_nWrites;
+
+/* -------------------------- Function prototypes -------------------------- */
+void MX_CRC_Init(void);
+HAL_StatusTypeDef HAL_CRC_Init(CRC_HandleTypeDef *h);
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef *h, uint32_t pBuffer[], 
+                            uint32_t BufferLength);
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *h, uint32_t pBuffer[], 
+                           uint32_t BufferLength);
+void CrcSim_reset(CRC_HandleTypeDef *h);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
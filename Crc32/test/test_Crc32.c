@@ -15,14 +15,35 @@
 /* --------------------------------- Notes --------------------------------- */
 /* ----------------------------- Include files ----------------------------- */
 #include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include "unity.h"
 #include "Crc32.h"
+#include "Crc32_ct.h"
+#include "Crc32_clmul.h"
+#include "Crc32_parallel.h"
+#include "Crc32_ref.h"
 #include "Mock_GStatus.h"
 #include "Mock_rfile.h"
 #include "Mock_Config.h"
 
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+TEST_FILE("Crc32_combine.c")
+TEST_FILE("Crc32_parallel.c")
+
 /* ----------------------------- Local macros ------------------------------ */
 /* ------------------------------- Constants ------------------------------- */
+#define CHECK_VALUE         0xcbf43926
+
+#define IMAGE_TAG           0x5a
+#define IMAGE_VALUE         0xdeadbeef
+#define IMAGE_LEVEL         -2
+#define IMAGE_BYTE(k) \
+    (CRC32_CT_FIELD_BYTE(k, IMAGE_TAG, uint8_t, offsetof(Image, tag)) | \
+     CRC32_CT_FIELD_BYTE(k, IMAGE_VALUE, uint32_t, offsetof(Image, value)) | \
+     CRC32_CT_FIELD_BYTE(k, IMAGE_LEVEL, int16_t, offsetof(Image, level)))
+
 /* ---------------------------- Local data types --------------------------- */
 typedef union SecBlock SecBlock;
 union SecBlock
@@ -32,10 +53,34 @@ union SecBlock
     GStatusType gStatusTypeData;
 };
 
+typedef struct Image Image;
+struct Image
+{
+    uint8_t tag;
+    uint32_t value;
+    int16_t level;
+};
+
 /* ---------------------------- Global variables --------------------------- */
 /* ---------------------------- Local variables ---------------------------- */
+static uint8_t message[512 + 16];
+static const Image image = {IMAGE_TAG, IMAGE_VALUE, IMAGE_LEVEL};
+CRC32_CT_DEFINE(imageCrc, sizeof(Image), 0xffffffff, IMAGE_BYTE);
+
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+static void
+fillMessage(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(message); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        message[i] = (uint8_t)(seed >> 16);
+    }
+}
+
 /* ---------------------------- Global functions --------------------------- */
 void
 setUp(void)
@@ -63,4 +108,328 @@ test_CalculateCRC32(void)
     TEST_ASSERT_EQUAL_HEX(expected, result);
 }
 
+void
+test_CalculateCheckValue(void)
+{
+    uint8_t check[] = "123456789";
+
+    Crc32_init();
+    TEST_ASSERT_EQUAL_HEX(CHECK_VALUE, 
+                          Crc32_calc(check, strlen(check), 0xffffffff));
+}
+
+void
+test_CalculateEmptyMessage(void)
+{
+    Crc32_init();
+    TEST_ASSERT_EQUAL_HEX(0, Crc32_calc(message, 0, 0xffffffff));
+}
+
+void
+test_MatchReferenceForEveryLengthAndAlignment(void)
+{
+    size_t len, offset;
+
+    Crc32_init();
+    fillMessage(0xcafe);
+    for (offset = 0; offset < 16; ++offset)
+    {
+        for (len = 0; len <= 64; ++len)
+        {
+            TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message + offset, len, 
+                                                0xffffffff),
+                                  Crc32_calc(message + offset, len, 
+                                             0xffffffff));
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message, 512, 0xffffffff),
+                          Crc32_calc(message, 512, 0xffffffff));
+}
+
+void
+test_MatchReferenceForArbitraryInit(void)
+{
+    uint32_t init[] = {0, 1, 0x80000000, 0x12345678, 0xdeadbeef};
+    size_t i;
+
+    Crc32_init();
+    fillMessage(0xbeef);
+    for (i = 0; i < sizeof(init) / sizeof(init[0]); ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message, 100, init[i]),
+                              Crc32_calc(message, 100, init[i]));
+    }
+}
+
+void
+test_FoldWithCarryLessMultiply(void)
+{
+    size_t len;
+    uint32_t remainder;
+
+    if (Crc32_clmulAvailable() == false)
+    {
+        TEST_IGNORE_MESSAGE("PCLMULQDQ is not supported by this CPU");
+    }
+    fillMessage(0xf01d);
+    for (len = 64; len <= 512; len += 16)
+    {
+        /* The fold works on the reflected remainder, not final-XORed */
+        remainder = Crc32_clmulFold(0xffffffff, message, len) ^ 0xffffffff;
+        TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message, len, 0xffffffff), 
+                              remainder);
+    }
+}
+
+void
+test_DispatchLongMessagesToCarryLessMultiply(void)
+{
+    size_t len;
+
+    Crc32_init();
+    fillMessage(0xd00d);
+    for (len = CRC32_CLMUL_THRESHOLD - 1; len <= 512; len += 7)
+    {
+        TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message + 3, len, 0xffffffff),
+                              Crc32_calc(message + 3, len, 0xffffffff));
+    }
+}
+
+void
+test_StreamScatteredMessage(void)
+{
+    Crc32Ctx ctx;
+    size_t split, len;
+
+    Crc32_init();
+    fillMessage(0xab1e);
+    for (len = 0; len <= 200; len += 25)
+    {
+        for (split = 0; split <= len; ++split)
+        {
+            Crc32_begin(&ctx, 0xffffffff);
+            Crc32_update(&ctx, message, split);
+            Crc32_update(&ctx, message + split, len - split);
+            TEST_ASSERT_EQUAL_HEX(Crc32_calc(message, len, 0xffffffff),
+                                  Crc32_final(&ctx));
+        }
+    }
+}
+
+void
+test_StreamByteByByte(void)
+{
+    Crc32Ctx ctx;
+    size_t i;
+
+    Crc32_init();
+    fillMessage(0x5eed);
+    Crc32_begin(&ctx, 0xffffffff);
+    for (i = 0; i < 300; ++i)
+    {
+        Crc32_update(&ctx, message + i, 1);
+    }
+    TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message, 300, 0xffffffff), 
+                          Crc32_final(&ctx));
+}
+
+void
+test_CopyAndCalculate(void)
+{
+    static uint8_t copy[sizeof(message)];
+    size_t len, offset;
+
+    Crc32_init();
+    fillMessage(0xc0b7);
+    for (offset = 0; offset < 4; ++offset)
+    {
+        for (len = 1; len <= (sizeof(message) - offset); len += 7)
+        {
+            memset(copy, 0, sizeof(copy));
+            TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, len, 
+                                             0xffffffff),
+                                  Crc32_copyCalc(copy + offset, 
+                                                 message + offset, len, 
+                                                 0xffffffff));
+            TEST_ASSERT_EQUAL_MEMORY(message + offset, copy + offset, len);
+        }
+    }
+}
+
+void
+test_CalculateSeveralBuffersAtOnce(void)
+{
+    static const size_t lens[] = {24, 0, 16, 1, 200, 24, 7, 512, 33};
+    const uint8_t *bufs[sizeof(lens) / sizeof(lens[0])];
+    Crc32 out[sizeof(lens) / sizeof(lens[0])];
+    size_t i, n;
+
+    Crc32_init();
+    fillMessage(0x3a17);
+    for (i = 0; i < (sizeof(lens) / sizeof(lens[0])); ++i)
+    {
+        bufs[i] = message + (i % 8);
+    }
+    for (n = 0; n <= (sizeof(lens) / sizeof(lens[0])); ++n)
+    {
+        memset(out, 0, sizeof(out));
+        Crc32_calcMulti(bufs, lens, out, n);
+        for (i = 0; i < n; ++i)
+        {
+            TEST_ASSERT_EQUAL_HEX(Crc32_calc(bufs[i], lens[i], 0xffffffff),
+                                  out[i]);
+        }
+    }
+}
+
+void
+test_CombineTwoMessages(void)
+{
+    Crc32 crcA, crcB;
+    size_t split;
+
+    Crc32_init();
+    fillMessage(0xc0de);
+    for (split = 0; split <= 300; split += 13)
+    {
+        crcA = Crc32_calc(message, split, 0xffffffff);
+        crcB = Crc32_calc(message + split, 300 - split, 0xffffffff);
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message, 300, 0xffffffff),
+                              Crc32_combine(crcA, crcB, 300 - split));
+    }
+}
+
+void
+test_PatchFieldAtRandomOffsets(void)
+{
+    uint8_t field[8], oldField[8];
+    uint32_t seed;
+    size_t offset, nBytes, totalLen;
+    Crc32 crc;
+    int i, j;
+
+    Crc32_init();
+    fillMessage(0x7a7c);
+    for (i = 0, seed = 1; i < 200; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        totalLen = 8 + (seed >> 8) % (sizeof(message) - 8);
+        nBytes = 1 + (seed >> 4) % sizeof(field);
+        offset = (seed >> 12) % (totalLen - nBytes + 1);
+        for (j = 0; j < sizeof(field); ++j)
+        {
+            field[j] = (uint8_t)(seed >> j);
+        }
+
+        crc = Crc32_calc(message, totalLen, 0xffffffff);
+        memcpy(oldField, message + offset, nBytes);
+        memcpy(message + offset, field, nBytes);
+        crc = Crc32_patch(crc, offset, oldField, field, nBytes, totalLen);
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message, totalLen, 0xffffffff), 
+                              crc);
+    }
+}
+
+void
+test_PatchOutOfTheMessageLeavesTheCrc(void)
+{
+    uint8_t field[4] = {1, 2, 3, 4};
+    Crc32 crc;
+
+    fillMessage(0x7a7c);
+    crc = Crc32_calc(message, 100, 0xffffffff);
+    TEST_ASSERT_EQUAL_HEX(crc, Crc32_patch(crc, 98, message + 98, field, 
+                                           4, 100));
+    TEST_ASSERT_EQUAL_HEX(crc, Crc32_patch(crc, 101, message, field, 
+                                           0, 100));
+}
+
+void
+test_CalculateInParallel(void)
+{
+    size_t len[] = {0, 8191, 8192, 100000, 1000003};
+    int nThreads[] = {1, 2, 3, 8};
+    uint8_t *buf;
+    size_t i, j;
+
+    buf = malloc(1000003);
+    TEST_ASSERT_NOT_NULL(buf);
+    for (i = 0; i < 1000003; ++i)
+    {
+        buf[i] = (uint8_t)((i * 2654435761u) >> 13);
+    }
+
+    Crc32_init();
+    Crc32_setChunkSize(4096);
+    for (i = 0; i < sizeof(len) / sizeof(len[0]); ++i)
+    {
+        for (j = 0; j < sizeof(nThreads) / sizeof(nThreads[0]); ++j)
+        {
+            TEST_ASSERT_EQUAL_HEX(Crc32_calc(buf + 1, len[i], 0x12345678),
+                                  Crc32_calcParallel(buf + 1, len[i], 
+                                                     0x12345678, 
+                                                     nThreads[j]));
+        }
+    }
+    Crc32_setChunkSize(0);
+    TEST_ASSERT_EQUAL_HEX(Crc32_calc(buf, 1000002, 0xffffffff),
+                          Crc32_calcParallel(buf, 1000002, 0xffffffff, 4));
+    free(buf);
+}
+
+void
+test_CalculateFixedLengths(void)
+{
+    size_t offset;
+
+    Crc32_init();
+    fillMessage(0xf1ed);
+    for (offset = 0; offset < 4; ++offset)
+    {
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 4, 0xffffffff),
+                              Crc32_calc4(message + offset, 0xffffffff));
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 8, 0xffffffff),
+                              Crc32_calc8(message + offset, 0xffffffff));
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 12, 0xffffffff),
+                              Crc32_calc12(message + offset, 0xffffffff));
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 16, 0xffffffff),
+                              Crc32_calc16(message + offset, 0xffffffff));
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 20, 0xffffffff),
+                              Crc32_calc20(message + offset, 0xffffffff));
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 24, 0xffffffff),
+                              Crc32_calc24(message + offset, 0xffffffff));
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 28, 0xffffffff),
+                              Crc32_calc28(message + offset, 0xffffffff));
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(message + offset, 32, 0x1234567),
+                              Crc32_calc32(message + offset, 0x1234567));
+    }
+}
+
+void
+test_SelectFixedLengthFromSizeof(void)
+{
+    Config config;
+    Crc32 crc;
+
+    Crc32_init();
+    memset(&config, 0xa5, sizeof(Config));
+    crc = CRC32_CALC_FIXED((const uint8_t *)&config, sizeof(Config), 
+                           0xffffffff);
+    TEST_ASSERT_EQUAL_HEX(Crc32_calc((const uint8_t *)&config, 
+                                     sizeof(Config), 0xffffffff), crc);
+    TEST_ASSERT_EQUAL_HEX(Crc32_calc(message, 5, 0xffffffff),
+                          CRC32_CALC_FIXED(message, 5, 0xffffffff));
+}
+
+void
+test_CalculateConstantImageAtCompileTime(void)
+{
+    static const Crc32 crc = CRC32_CT_VALUE(imageCrc);
+
+    Crc32_init();
+    TEST_ASSERT_EQUAL_HEX(Crc32_calc((const uint8_t *)&image, sizeof(Image), 
+                                     0xffffffff), crc);
+    TEST_ASSERT_EQUAL_HEX(0xedb88320, CRC32_POLY_REFLECTED);
+}
+
 /* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,103 @@
+/**
+ *  \file       test_Crc32_slice16.c
+ *  \brief      Unit test for the CRC32_KERNEL_SLICE16 kernel of Crc32_sw.c
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci  lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built with CRC32_KERNEL set to CRC32_KERNEL_SLICE16 and with 
+ *  CRC32_NO_CLMUL defined (see project.yml), so that the kernel computes 
+ *  every message, whatever its length. test_Crc32.c checks the default 
+ *  one.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "Crc32.h"
+#include "Crc32_ref.h"
+
+TEST_FILE("Crc32_sw.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define CHECK_VALUE         0xcbf43926
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint8_t message[512 + 16];
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    uint32_t seed = 0xcafe;
+    size_t i;
+
+    Crc32_init();
+    for (i = 0; i < sizeof(message); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        message[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+void
+tearDown(void)
+{
+}
+
+void
+test_CalculateCheckValue(void)
+{
+    uint8_t check[] = "123456789";
+
+    TEST_ASSERT_EQUAL_HEX(CHECK_VALUE, 
+                          Crc32_calc(check, strlen(check), 0xffffffff));
+}
+
+void
+test_MatchReferenceForEveryLengthAndAlignment(void)
+{
+    size_t len, offset;
+
+    for (offset = 0; offset < 16; ++offset)
+    {
+        for (len = 0; len <= 64; ++len)
+        {
+            TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message + offset, len, 
+                                                0xffffffff),
+                                  Crc32_calc(message + offset, len, 
+                                             0xffffffff));
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message, 512, 0xffffffff),
+                          Crc32_calc(message, 512, 0xffffffff));
+}
+
+void
+test_MatchReferenceForArbitraryInit(void)
+{
+    uint32_t init[] = {0, 1, 0x80000000, 0x12345678, 0xdeadbeef};
+    size_t i;
+
+    for (i = 0; i < sizeof(init) / sizeof(init[0]); ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX(Crc32Ref_calc(message, 100, init[i]),
+                              Crc32_calc(message, 100, init[i]));
+    }
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,138 @@
+/**
+ *  \file       test_Crc32_stm32.c
+ *  \brief      Unit test for the word-fed mode of Crc32_stm32.c
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci  lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It runs on the CRC unit simulated by test/support/crc.c, and it is 
+ *  built with CRC32_STM32_WORD_FED defined (see project.yml).
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "Crc32.h"
+#include "crc.h"
+
+TEST_FILE("Crc32_stm32.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define CHECK_VALUE         0xcbf43926
+#define POLYNOMIAL          0xedb88320      /* reflected */
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint32_t words[(256 + 8) / sizeof(uint32_t)];
+static uint8_t *message = (uint8_t *)words;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static Crc32
+calcCrc32(const uint8_t *buf, size_t len)
+{
+    Crc32 remainder = 0xffffffff;
+    int bit;
+
+    for (; len != 0; --len, ++buf)
+    {
+        remainder ^= *buf;
+        for (bit = 0; bit < 8; ++bit)
+        {
+            remainder = (remainder & 0x01) ? (remainder >> 1) ^ POLYNOMIAL :
+                                             (remainder >> 1);
+        }
+    }
+    return remainder ^ 0xffffffff;
+}
+
+static void
+fillMessage(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(words); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        message[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    MX_CRC_Init();
+    Crc32_init();
+    CrcSim_nWrites = 0;
+}
+
+void
+tearDown(void)
+{
+}
+
+void
+test_CalculateCheckValue(void)
+{
+    memcpy(message, "123456789", 9);
+    TEST_ASSERT_EQUAL_HEX(CHECK_VALUE, Crc32_calc(message, 9, 0xffffffff));
+    memcpy(message + 3, "123456789", 9);
+    TEST_ASSERT_EQUAL_HEX(CHECK_VALUE, 
+                          Crc32_calc(message + 3, 9, 0xffffffff));
+}
+
+void
+test_FeedAlignedWordsToTheUnit(void)
+{
+    size_t offset, len;
+
+    fillMessage(0x57);
+    for (offset = 0; offset < 4; ++offset)
+    {
+        for (len = 0; len <= 40; ++len)
+        {
+            CrcSim_nWrites = 0;
+            TEST_ASSERT_EQUAL_HEX(calcCrc32(message + offset, len),
+                                  Crc32_calc(message + offset, len, 
+                                             0xffffffff));
+            TEST_ASSERT_TRUE(CrcSim_nWrites <= (len / 4));
+        }
+    }
+    CrcSim_nWrites = 0;
+    TEST_ASSERT_EQUAL_HEX(calcCrc32(message + 1, 256),
+                          Crc32_calc(message + 1, 256, 0xffffffff));
+    TEST_ASSERT_EQUAL(63, CrcSim_nWrites);
+}
+
+void
+test_KeepSeveralContextsOpen(void)
+{
+    Crc32Ctx a, b;
+    size_t i;
+
+    fillMessage(0xc7);
+    Crc32_begin(&a, 0xffffffff);
+    Crc32_begin(&b, 0xffffffff);
+    for (i = 0; i < 128; i += 16)
+    {
+        Crc32_update(&a, message + i, 16);
+        Crc32_update(&b, message + 128 + i, 5);
+        Crc32_update(&b, message + 128 + i + 5, 11);
+    }
+    TEST_ASSERT_EQUAL_HEX(calcCrc32(message, 128), Crc32_final(&a));
+    TEST_ASSERT_EQUAL_HEX(calcCrc32(message + 128, 128), Crc32_final(&b));
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -18,23 +18,161 @@
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  NVMem_readData() and NVMem_storeData() are provided by the platform. 
+ *  On Linux hosts, NVMem_mmap.c provides them on top of an image file, 
+ *  and NVMem_aio.c on top of an image file or a block device, along 
+ *  with an asynchronous interface. NVMem_sim.c provides them on top of 
+ *  a simulated flash part, to measure the cost of the stores on the host.
+ *  NVMem_eeprom.c provides them on top of a serial EEPROM, page by page, 
+ *  and NVMem_eepromSim.c simulates the part on the host.
+ *
+ *  When NVMEM_CACHE is defined, NVMem_cache.c serves reads from RAM and 
+ *  holds stores until NVMem_flush() is called or too many lines are 
+ *  dirty. Otherwise NVMem_flush() does nothing.
+ *
+ *  With NVMEM_ELIDE, stores leave alone the bytes which already hold 
+ *  the stored value. The cache compares them against its lines, without 
+ *  it NVMem_elide.c reads them back, chunk by chunk. NVMem_getStats() 
+ *  reports the elided bytes.
+ *
+ *  NVMem_queue.c provides NVMem_storeDataAsync(), which queues stores 
+ *  to be done by NVMem_storeData() from a worker thread or an idle hook, 
+ *  and the NVMem_sync() barrier.
+ *
+ *  NVMem_readv() and NVMem_writev() transfer an array of segments, 
+ *  which must not overlap, as they can be transferred in any order. By 
+ *  default, the segments which are contiguous both in the memory and in 
+ *  RAM are merged into a single transfer. NVMem_aio.c, built with 
+ *  NVMEM_DEV_VECTORED, submits all of them at once, so they overlap in 
+ *  time.
+ *
+ *  NVMem_map() returns a pointer to the stored bytes, valid until the 
+ *  next store, or NULL when they are not memory-mapped. They are mapped 
+ *  at NVMEM_BASE_ADDR, without the cache, and by NVMem_mmap.c, built 
+ *  with NVMEM_DEV_MAP.
+ *
+ *  NVMem_part.h lays out the regions of the part, from a compile-time 
+ *  partition table, so that modules take their addresses from it.
+ *
+ *  With NVMEM_WEAR, NVMem_wear.c maps the address space onto a pool of 
+ *  sectors, so that the sectors which are stored most often are not 
+ *  worn out before the rest of the part. It can not be combined with 
+ *  NVMEM_CACHE or NVMEM_ELIDE.
+ *
+ *  NVMem_sched.c schedules the requests of the modules sharing the part, 
+ *  by priority class, deadline and bandwidth budget, splitting them in 
+ *  chunks so that a large request does not hold back an urgent one.
+ *
+ *  NVMem_log.c keeps records identified by an id on top of these 
+ *  functions, appending every update to a log of flash sectors instead 
+ *  of overwriting it in place.
+ *
+ *  NVMem_readDataCrc() reads as NVMem_readData() does and also returns 
+ *  the CRC-32 of the read bytes, calculated with the 0xffffffff init 
+ *  value, without walking the destination buffer again.
+ */
+
 /* --------------------------------- Module -------------------------------- */
 #ifndef __NVMEM_H__
 #define __NVMEM_H__
 
 /* ----------------------------- Include files ----------------------------- */
+#include <stdint.h>
+#include "Crc32.h"
+
 /* ---------------------- External C language linkage ---------------------- */
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /* --------------------------------- Macros -------------------------------- */
+/**
+ *  Names of the device entry points, implemented by the platform or by 
+ *  one of the back-ends. Without NVMEM_CACHE, NVMEM_ELIDE and NVMEM_WEAR 
+ *  they are NVMem_readData() and NVMem_storeData() themselves, otherwise 
+ *  NVMem_cache.c, NVMem_elide.c or NVMem_wear.c implements these ones on 
+ *  top of them.
+ */
+#if defined(NVMEM_WEAR) && (defined(NVMEM_CACHE) || defined(NVMEM_ELIDE))
+#error "NVMEM_WEAR can not be combined with NVMEM_CACHE or NVMEM_ELIDE"
+#endif
+
+#if defined(NVMEM_CACHE) || defined(NVMEM_ELIDE) || defined(NVMEM_WEAR)
+#define NVMEM_DEV_READ          NVMemDev_readData
+#define NVMEM_DEV_STORE         NVMemDev_storeData
+#else
+#define NVMEM_DEV_READ          NVMem_readData
+#define NVMEM_DEV_STORE         NVMem_storeData
+#endif
+
+/**
+ *  A back-end defining NVMEM_DEV_VECTORED implements NVMem_readv() and 
+ *  NVMem_writev() by itself, unless another layer is on top of it.
+ */
+#if defined(NVMEM_DEV_VECTORED) && \
+    !defined(NVMEM_CACHE) && !defined(NVMEM_ELIDE) && !defined(NVMEM_WEAR)
+#define NVMEM_VECTORED_BY_DEV   1
+#else
+#define NVMEM_VECTORED_BY_DEV   0
+#endif
+
+/**
+ *  A back-end defining NVMEM_DEV_MAP implements NVMem_map() by itself, 
+ *  unless the cache is on top of it, as it holds the latest bytes, or 
+ *  the wear-leveling layer, as it moves them.
+ */
+#if defined(NVMEM_DEV_MAP) && !defined(NVMEM_CACHE) && !defined(NVMEM_WEAR)
+#define NVMEM_MAP_BY_DEV        1
+#else
+#define NVMEM_MAP_BY_DEV        0
+#endif
+
 /* -------------------------------- Constants ------------------------------ */
+/**
+ *  Policies of the file-backed back-ends, NVMem_mmap.c and NVMem_aio.c, 
+ *  to write stores back to the file.
+ */
+typedef enum NVMemSync NVMemSync;
+enum NVMemSync
+{
+    NVMEM_SYNC_IMMEDIATE, NVMEM_SYNC_RANGED, NVMEM_SYNC_DEFERRED
+};
+
 /* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemSeg NVMemSeg;
+struct NVMemSeg
+{
+    uint32_t addr;
+    uint32_t nBytes;
+    uint8_t *buf;               /* not written by NVMem_writev() */
+};
+
+typedef struct NVMemStats NVMemStats;
+struct NVMemStats
+{
+    uint32_t bytesStored;
+    uint32_t bytesElided;       /* left unchanged, not written */
+};
+
 /* -------------------------- External variables --------------------------- */
 /* -------------------------- Function prototypes -------------------------- */
 void NVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to);
 void NVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from);
+void NVMem_readDataCrc(uint32_t from, uint32_t nBytes, uint8_t *to, 
+                       Crc32 *crc);
+void NVMem_readv(const NVMemSeg *segs, uint32_t nSegs);
+void NVMem_writev(const NVMemSeg *segs, uint32_t nSegs);
+const void *NVMem_map(uint32_t addr, uint32_t nBytes);
+void NVMem_flush(void);
+#if defined(NVMEM_CACHE) || defined(NVMEM_ELIDE) || defined(NVMEM_WEAR)
+void NVMemDev_readData(uint32_t from, uint32_t nBytes, uint8_t *to);
+void NVMemDev_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from);
+#endif
+#if defined(NVMEM_CACHE) || defined(NVMEM_ELIDE)
+void NVMem_getStats(NVMemStats *stats);
+void NVMem_resetStats(void);
+#endif
 
 /* -------------------- External C language linkage end -------------------- */
 #ifdef __cplusplus
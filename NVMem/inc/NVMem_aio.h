@@ -0,0 +1,132 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_aio.h
+ *  \brief  Specifies the asynchronous file-backed NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It provides NVMem_readData() and NVMem_storeData() on Linux hosts, on 
+ *  top of an image file or a block device opened by NVMemAio_open(), 
+ *  and an asynchronous interface to the same image:
+ *
+ *      NVMemAio_submit(&req);      queues a request, no syscall
+ *      ...
+ *      NVMemAio_complete(true);    submits the queued requests at once, 
+ *                                  waits for at least one of them and 
+ *                                  calls the done callback of every 
+ *                                  completed request
+ *
+ *  NVMem_readData() and NVMem_storeData() submit a request and complete 
+ *  until it is done, so callbacks of other requests can be called from 
+ *  them.
+ *  With NVMEM_DEV_VECTORED, NVMem_readv() and NVMem_writev() submit 
+ *  up to 16 segments before waiting for them.
+ *
+ *  Completed stores widen a dirty range, which is written back to the 
+ *  disk according to the NVMemSync policy given to NVMemAio_open(), 
+ *  like NVMem_mmap.c does:
+ *
+ *  NVMEM_SYNC_IMMEDIATE    NVMem_storeData() and NVMem_writev() 
+ *                          synchronize the whole file, fsync().
+ *  NVMEM_SYNC_RANGED       they synchronize only the dirty range.
+ *  NVMEM_SYNC_DEFERRED     the dirty range is synchronized by 
+ *                          NVMemAio_sync() or NVMemAio_close().
+ *
+ *  Stores submitted by NVMemAio_submit() are synchronized along with 
+ *  the next synchronous store, or by NVMemAio_sync(). A range is 
+ *  synchronized by a ranged fdatasync() operation of the ring, the 
+ *  thread pool has none, so it synchronizes the data of the whole file.
+ *  A range which fails to be synchronized, or the range of a 
+ *  NVMem_writev() some segment of which failed, stays dirty until the 
+ *  next sync.
+ *
+ *  Requests are served by io_uring when the kernel supports it, 
+ *  otherwise, or with NVMEM_AIO_THREADS, by a pool of threads calling 
+ *  pread() and pwrite(). The buffer given to NVMemAio_register() is 
+ *  registered with the ring, so requests whose buffer lies within it 
+ *  skip the page pinning of every transfer.
+ *
+ *  Requests run in any order, as the disk does them. A request must not 
+ *  be reused until its done callback is called. None of these functions 
+ *  is thread-safe, they are meant to be called from a single event loop.
+ *
+ *  Like NVMem_mmap.c, the part of an image beyond the end of its file 
+ *  reads as erased, 0xff. req->result is 0 on success or a negative 
+ *  errno value. NVMem_readData() gives erased bytes on errors.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_AIO_H__
+#define __NVMEM_AIO_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "NVMem.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+/* -------------------------------- Constants ------------------------------ */
+#define NVMEM_AIO_ERASED_VALUE  0xff
+
+typedef enum NVMemAioMode NVMemAioMode;
+enum NVMemAioMode
+{
+    NVMEM_AIO_AUTO, NVMEM_AIO_THREADS
+};
+
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemAioReq NVMemAioReq;
+typedef void (*NVMemAioDone)(NVMemAioReq *req);
+
+struct NVMemAioReq
+{
+    uint32_t addr;
+    uint32_t nBytes;
+    uint8_t *buf;
+    bool store;
+    NVMemAioDone done;
+    void *ctx;
+    int result;
+    NVMemAioReq *next;      /* private */
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool NVMemAio_open(const char *path, uint32_t size, unsigned int depth, 
+                   NVMemAioMode mode, NVMemSync policy);
+bool NVMemAio_sync(void);
+void NVMemAio_close(void);
+bool NVMemAio_usingRing(void);
+bool NVMemAio_register(uint8_t *buf, size_t nBytes);
+void NVMemAio_submit(NVMemAioReq *req);
+unsigned int NVMemAio_complete(bool wait);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
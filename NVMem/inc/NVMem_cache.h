@@ -0,0 +1,105 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_cache.h
+ *  \brief  Specifies the read cache and write-back buffer of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built when NVMEM_CACHE is defined, on top of the device entry 
+ *  points NVMemDev_readData() and NVMemDev_storeData().
+ *
+ *  The cache holds NVMEM_CACHE_LINES lines of NVMEM_CACHE_LINE bytes, 
+ *  aligned to their size, which should be the page size of the device. 
+ *  A line is filled from the device the first time it is read or 
+ *  partially stored, and is replaced in LRU order. Stores only modify 
+ *  the lines, so overlapping and adjacent stores are merged. Dirty lines 
+ *  are written back by NVMem_flush(), in bursts of up to 
+ *  NVMEM_CACHE_BURST_LINES consecutive lines per device store, and by 
+ *  NVMem_storeData() itself when NVMEM_CACHE_DIRTY_MAX lines are dirty. 
+ *  Reads of NVMEM_CACHE_BYPASS bytes or more go straight to the device, 
+ *  the cached lines are copied over them. The part of a store which 
+ *  matches the bytes of a cached line does not dirty it, with 
+ *  NVMEM_ELIDE even whole lines are filled to be compared.
+ *
+ *  Until NVMem_flush() returns, stores are lost on a reset, so callers 
+ *  which depend on their order, e.g. main before backup, must flush in 
+ *  between. NVMemCache_invalidate() flushes and drops every line, e.g. 
+ *  after the device was written by other means.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_CACHE_H__
+#define __NVMEM_CACHE_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdint.h>
+#include "NVMem.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#ifndef NVMEM_CACHE_LINE
+#define NVMEM_CACHE_LINE            256
+#endif
+
+#ifndef NVMEM_CACHE_LINES
+#define NVMEM_CACHE_LINES           16
+#endif
+
+#ifndef NVMEM_CACHE_DIRTY_MAX
+#define NVMEM_CACHE_DIRTY_MAX       (NVMEM_CACHE_LINES / 2)
+#endif
+
+#ifndef NVMEM_CACHE_BURST_LINES
+#define NVMEM_CACHE_BURST_LINES     4
+#endif
+
+#ifndef NVMEM_CACHE_BYPASS
+#define NVMEM_CACHE_BYPASS          (NVMEM_CACHE_LINES * NVMEM_CACHE_LINE)
+#endif
+
+/* -------------------------------- Constants ------------------------------ */
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemCacheStats NVMemCacheStats;
+struct NVMemCacheStats
+{
+    uint32_t nHits;             /* lines */
+    uint32_t nMisses;           /* lines */
+    uint32_t nBursts;           /* device stores */
+    uint32_t bytesStored;
+    uint32_t bytesElided;       /* matching the cached bytes */
+    uint32_t bytesWritten;      /* to the device */
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+void NVMemCache_invalidate(void);
+void NVMemCache_getStats(NVMemCacheStats *stats);
+void NVMemCache_resetStats(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,105 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_eeprom.h
+ *  \brief  Specifies the page-aware serial EEPROM back-end of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It provides NVMem_readData() and NVMem_storeData() on top of an I2C
+ *  or SPI EEPROM, whose bus transactions are provided by the platform:
+ *
+ *      NVMemEeprom_busRead()   sequential read, from any address
+ *      NVMemEeprom_busWrite()  page write, which must not cross a page,
+ *                              as the part wraps around within the page
+ *      NVMemEeprom_busReady()  acknowledge polling on I2C, or the WIP
+ *                              bit of the status register on SPI
+ *
+ *  A page write costs a whole write cycle no matter how many bytes it
+ *  writes, so stores are split at the boundaries of the pages of
+ *  NVMEM_EEPROM_PAGE bytes and each part of a page is written by a
+ *  single page write. Built with NVMEM_DEV_VECTORED, NVMem_writev()
+ *  gathers the consecutive segments which fall in the same page into a
+ *  single page write as well, reading the bytes in between from the
+ *  part, so that adjacent fields of a block cost one write cycle.
+ *
+ *  Instead of waiting a fixed worst-case delay after a page write, the
+ *  part is polled before the next transaction, so a store returns while
+ *  the part is still writing its last page, and the part is given up
+ *  after NVMEM_EEPROM_POLL_MAX polls. A page write is given up, and
+ *  counted as dropped, when the part does not acknowledge it or when
+ *  the bytes joining its segments can not be read, so that a store
+ *  never overwrites the bytes around it with made-up ones.
+ *  NVMem_eepromSim.c provides the bus transactions on the host, on top
+ *  of a simulated part.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_EEPROM_H__
+#define __NVMEM_EEPROM_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#ifndef NVMEM_EEPROM_PAGE
+#define NVMEM_EEPROM_PAGE           128
+#endif
+
+#ifndef NVMEM_EEPROM_POLL_MAX
+#define NVMEM_EEPROM_POLL_MAX       100000
+#endif
+
+/* -------------------------------- Constants ------------------------------ */
+#define NVMEM_EEPROM_ERASED_VALUE   0xff
+
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemEepromStats NVMemEepromStats;
+struct NVMemEepromStats
+{
+    uint32_t nPageWrites;
+    uint32_t bytesStored;
+    uint32_t bytesFilled;       /* read to join segments of a page */
+    uint32_t nPolls;            /* while the part was busy */
+    uint32_t nTimeouts;
+    uint32_t nDropped;          /* page writes given up */
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+void NVMemEeprom_getStats(NVMemEepromStats *stats);
+void NVMemEeprom_resetStats(void);
+bool NVMemEeprom_busRead(uint32_t from, uint32_t nBytes, uint8_t *to);
+bool NVMemEeprom_busWrite(uint32_t to, uint32_t nBytes,
+                          const uint8_t *from);
+bool NVMemEeprom_busReady(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,118 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_eepromSim.h
+ *  \brief  Specifies the simulated serial EEPROM on the host.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It provides the bus transactions of NVMem_eeprom.c on top of an I2C
+ *  or SPI EEPROM simulated in RAM, so that the cost of the stores can be
+ *  measured on the host.
+ *
+ *  Every transaction advances the simulated time, given by
+ *  NVMemEepromSim_now(), by byteNs for each byte on the bus, cmdBytes
+ *  being the command and address bytes of a read or a write and
+ *  pollBytes the ones of a poll. A page write starts a write cycle of
+ *  writeNs, during which the part does not acknowledge reads and
+ *  writes, which count a violation, as the real part would. Like the
+ *  real part, a page write which goes beyond the end of its page wraps
+ *  around to the start of the page. NVMemEepromSim_nack() makes the
+ *  part leave the next reads and writes unacknowledged, as on a noisy
+ *  bus.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_EEPROMSIM_H__
+#define __NVMEM_EEPROMSIM_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem_eeprom.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+/**
+ *  A 64 KiB part with 128-byte pages and a typical write cycle, on a
+ *  400 kHz I2C bus, 9 clocks per byte, and on a 10 MHz SPI bus.
+ */
+#define NVMEM_EEPROM_SIM_I2C_CFG \
+    { \
+        64 * 1024,      /* size */ \
+        128,            /* pageSize */ \
+        3500000,        /* writeNs */ \
+        22500,          /* byteNs */ \
+        3,              /* cmdBytes */ \
+        1               /* pollBytes */ \
+    }
+
+#define NVMEM_EEPROM_SIM_SPI_CFG \
+    { \
+        64 * 1024,      /* size */ \
+        128,            /* pageSize */ \
+        3500000,        /* writeNs */ \
+        800,            /* byteNs */ \
+        3,              /* cmdBytes */ \
+        2               /* pollBytes */ \
+    }
+
+/* -------------------------------- Constants ------------------------------ */
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemEepromSimCfg NVMemEepromSimCfg;
+struct NVMemEepromSimCfg
+{
+    uint32_t size;
+    uint32_t pageSize;
+    uint32_t writeNs;
+    uint32_t byteNs;
+    uint32_t cmdBytes;
+    uint32_t pollBytes;
+};
+
+typedef struct NVMemEepromSimStats NVMemEepromSimStats;
+struct NVMemEepromSimStats
+{
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    uint32_t nPageWrites;
+    uint32_t nPolls;
+    uint32_t nViolations;
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool NVMemEepromSim_open(const NVMemEepromSimCfg *cfg);
+void NVMemEepromSim_close(void);
+uint64_t NVMemEepromSim_now(void);
+void NVMemEepromSim_wait(uint64_t ns);
+void NVMemEepromSim_nack(uint32_t nTransactions);
+void NVMemEepromSim_getStats(NVMemEepromSimStats *stats);
+void NVMemEepromSim_resetStats(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
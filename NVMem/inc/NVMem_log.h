@@ -0,0 +1,105 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_log.h
+ *  \brief  Specifies the log-structured record store on top of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The store keeps up to NVMEM_LOG_MAX_IDS records, each one identified
+ *  by its id. Updating a record does not overwrite it, but appends a new
+ *  (crc, seq, id, len, payload) record to the sector being filled, so
+ *  that most of the updates only program erased bytes. The record with
+ *  the greatest sequence number and a valid CRC is the current one.
+ *
+ *  The region is a ring of NVMEM_SECTOR_SIZE sectors, each one starting
+ *  with a header holding its own sequence number, so that the newest
+ *  sector is found at NVMemLog_open(), which scans the used ones to
+ *  index the current records in RAM. At least one sector is kept
+ *  erased: when the sector being filled is full, the next one is
+ *  started and, if there is no erased sector left, the oldest one is
+ *  collected, copying its current records to the new one and erasing
+ *  it. The current records of a sector always fit in an empty one, as
+ *  NVMEM_LOG_MAX_IDS records of NVMEM_LOG_MAX_LEN bytes must fit in a
+ *  sector, which is checked at compile time.
+ *
+ *  A sector which is not erased yet is erased by storing a whole sector
+ *  of erased bytes over it, as the driver of the part erases the sector
+ *  when a store needs to set a bit. A record or a sector header torn by
+ *  a reset fails its CRC and is ignored, and the collection of a sector
+ *  torn by a reset is completed at the next NVMemLog_open().
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_LOG_H__
+#define __NVMEM_LOG_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem.h"
+#include "NVMem_part.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#ifndef NVMEM_LOG_MAX_IDS
+#define NVMEM_LOG_MAX_IDS       16
+#endif
+
+#ifndef NVMEM_LOG_MAX_LEN
+#define NVMEM_LOG_MAX_LEN       128
+#endif
+
+#ifndef NVMEM_LOG_MAX_SECTORS
+#define NVMEM_LOG_MAX_SECTORS   8
+#endif
+
+/* -------------------------------- Constants ------------------------------ */
+#define NVMEM_LOG_ERASED_VALUE  0xff
+
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemLogStats NVMemLogStats;
+struct NVMemLogStats
+{
+    uint32_t nWrites;
+    uint32_t bytesWritten;      /* payload of the written records */
+    uint32_t bytesAppended;     /* records and sector headers */
+    uint32_t nCollections;
+    uint32_t bytesCopied;       /* records copied by the collections */
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool NVMemLog_open(uint32_t addr, uint32_t nSectors);
+bool NVMemLog_write(uint16_t id, const void *data, uint16_t len);
+bool NVMemLog_read(uint16_t id, void *data, uint16_t maxLen,
+                   uint16_t *len);
+void NVMemLog_getStats(NVMemLogStats *stats);
+void NVMemLog_resetStats(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
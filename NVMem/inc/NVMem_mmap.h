@@ -0,0 +1,76 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_mmap.h
+ *  \brief  Specifies the POSIX file-backed NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It provides NVMem_readData() and NVMem_storeData() on Linux hosts, on 
+ *  top of an image file mapped by NVMemMmap_open(). Reads and stores are 
+ *  plain copies from and to the mapping, and stores are written back to 
+ *  the file according to an NVMemSync policy:
+ *
+ *  NVMEM_SYNC_IMMEDIATE    every store synchronizes the whole image.
+ *  NVMEM_SYNC_RANGED       every store synchronizes only the pages it 
+ *                          touched.
+ *  NVMEM_SYNC_DEFERRED     stores only widen a dirty range, which is 
+ *                          synchronized by NVMemMmap_sync() or 
+ *                          NVMemMmap_close().
+ *
+ *  A new image, or the part of an image beyond the end of its file, 
+ *  reads as erased flash, 0xff. Reads out of the image also give 0xff 
+ *  and stores out of it are discarded, so that the CRC of the block 
+ *  does not match.
+ *
+ *  With NVMEM_DEV_MAP, NVMem_map() returns a pointer into the mapping, 
+ *  NULL when the range is out of the image.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_MMAP_H__
+#define __NVMEM_MMAP_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+/* -------------------------------- Constants ------------------------------ */
+#define NVMEM_ERASED_VALUE      0xff
+
+/* ------------------------------- Data types ------------------------------ */
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool NVMemMmap_open(const char *path, uint32_t size, NVMemSync policy);
+bool NVMemMmap_sync(void);
+void NVMemMmap_close(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
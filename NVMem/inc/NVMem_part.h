@@ -0,0 +1,133 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_part.h
+ *  \brief  Specifies the partition table of the non-volatile memory.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The partition table is NVMEM_PART_TABLE(X), a list of
+ *  X(name, size, align) entries, which the application may define
+ *  before including this file. Regions are laid out in the order of the
+ *  table, each one starting at the first multiple of its alignment and
+ *  padded to a multiple of it, so regions can not overlap and a region
+ *  aligned to NVMEM_SECTOR_SIZE never shares an erase sector with
+ *  another one. The layout is calculated by the compiler, as the
+ *  offsets of the members of an aligned struct, so that
+ *
+ *      NVMEM_PART_ADDR(name)   address of the region
+ *      NVMEM_PART_SIZE(name)   size of the region, padding included
+ *      NVMEM_PART_ID(name)     index of the region in the table
+ *      NVMEM_PART_END          end of the last region
+ *
+ *  are constant expressions. The alignment of every region must be a
+ *  power of two multiple of NVMEM_PAGE_SIZE, and the whole layout must
+ *  fit in NVMEM_SIZE bytes, which is checked at compile time.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_PART_H__
+#define __NVMEM_PART_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#ifndef NVMEM_SIZE
+#define NVMEM_SIZE                  (64 * 1024)
+#endif
+
+#ifndef NVMEM_PAGE_SIZE
+#define NVMEM_PAGE_SIZE             256
+#endif
+
+#ifndef NVMEM_SECTOR_SIZE
+#define NVMEM_SECTOR_SIZE           4096
+#endif
+
+/**
+ *  Default table. Config.alt1 and Config.alt2 store a single copy in
+ *  CONFIG, Config.recovery stores its main and backup copies in
+ *  CONFIG_MAIN and CONFIG_BACKUP. NVMem_log.c appends its records to the
+ *  sectors of LOG.
+ */
+#ifndef NVMEM_PART_TABLE
+#define NVMEM_PART_TABLE(X) \
+    X(CONFIG_MAIN,      NVMEM_SECTOR_SIZE,  NVMEM_SECTOR_SIZE) \
+    X(CONFIG_BACKUP,    NVMEM_SECTOR_SIZE,  NVMEM_SECTOR_SIZE) \
+    X(CONFIG,           NVMEM_SECTOR_SIZE,  NVMEM_SECTOR_SIZE) \
+    X(LOG,              4 * NVMEM_SECTOR_SIZE, NVMEM_SECTOR_SIZE)
+#endif
+
+#define NVMEM_PART_ROUND_UP(size, align) \
+    ((((size) + (align) - 1) / (align)) * (align))
+
+#define NVMEM_PART_ADDR(name)   ((uint32_t)offsetof(NVMemPartLayout, name))
+#define NVMEM_PART_SIZE(name) \
+    ((uint32_t)sizeof(((NVMemPartLayout *)0)->name))
+#define NVMEM_PART_ID(name)     NVMEM_PART_ID_##name
+#define NVMEM_PART_END          ((uint32_t)offsetof(NVMemPartLayout, end))
+
+#define NVMEM_PART_MEMBER(name, size, align) \
+    _Alignas(align) uint8_t name[NVMEM_PART_ROUND_UP(size, align)];
+
+#define NVMEM_PART_ENUM(name, size, align) \
+    NVMEM_PART_ID_##name,
+
+#define NVMEM_PART_CHECK(name, size, align) \
+    _Static_assert(((align) % NVMEM_PAGE_SIZE) == 0, \
+                   "NVMem region " #name " is not page aligned"); \
+    _Static_assert(((align) & ((align) - 1)) == 0, \
+                   "NVMem region " #name " alignment is not a power of 2"); \
+    _Static_assert((size) != 0, "NVMem region " #name " is empty");
+
+/* -------------------------------- Constants ------------------------------ */
+typedef enum NVMemPartId NVMemPartId;
+enum NVMemPartId
+{
+    NVMEM_PART_TABLE(NVMEM_PART_ENUM)
+    NVMEM_NUM_PARTS
+};
+
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemPartLayout NVMemPartLayout;
+struct NVMemPartLayout
+{
+    NVMEM_PART_TABLE(NVMEM_PART_MEMBER)
+    uint8_t end[];
+};
+
+NVMEM_PART_TABLE(NVMEM_PART_CHECK)
+_Static_assert(NVMEM_PART_END <= NVMEM_SIZE,
+               "NVMem partition table does not fit in NVMEM_SIZE");
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,93 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_queue.h
+ *  \brief  Specifies the asynchronous store queue of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  NVMem_storeDataAsync() queues a store and returns at once, or returns
+ *  false when the NVMEM_QUEUE_SIZE entries of the queue are in use.
+ *  Stores are done by NVMem_storeData() in the order they were queued,
+ *  so a store never overtakes an earlier one to the same range, and
+ *  then their done callback is called, from the context draining the
+ *  queue. The source buffer must be kept until then.
+ *
+ *  With NVMEM_QUEUE_THREAD, the default on Linux, the queue is drained
+ *  by a thread started by NVMemQueue_open(). Otherwise the application
+ *  drains it by calling NVMemQueue_drain(), e.g. from its idle hook.
+ *
+ *  The queue is lock-free, so NVMem_storeDataAsync() can be called from
+ *  several threads or from interrupts. NVMem_sync() waits until every
+ *  store queued before it is done and then calls NVMem_flush(), so a
+ *  store queued after it is written after them, e.g. the backup after
+ *  the main copy. Stores and reads done directly by NVMem_storeData()
+ *  and NVMem_readData() are not ordered with the queued ones, call
+ *  NVMem_sync() before them. NVMem_sync() must not be called from a
+ *  done callback.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_QUEUE_H__
+#define __NVMEM_QUEUE_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#ifndef NVMEM_QUEUE_SIZE
+#define NVMEM_QUEUE_SIZE            8       /* power of two */
+#endif
+
+#ifndef NVMEM_QUEUE_THREAD
+#if defined(__linux__)
+#define NVMEM_QUEUE_THREAD          1
+#else
+#define NVMEM_QUEUE_THREAD          0
+#endif
+#endif
+
+/* -------------------------------- Constants ------------------------------ */
+/* ------------------------------- Data types ------------------------------ */
+typedef void (*NVMemStoreDone)(void *ctx);
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool NVMemQueue_open(void);
+void NVMemQueue_close(void);
+#if NVMEM_QUEUE_THREAD == 0
+unsigned int NVMemQueue_drain(void);
+#endif
+bool NVMem_storeDataAsync(uint32_t to, uint32_t nBytes, const uint8_t *from,
+                          NVMemStoreDone done, void *ctx);
+void NVMem_sync(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
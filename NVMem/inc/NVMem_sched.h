@@ -0,0 +1,161 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_sched.h
+ *  \brief  Specifies the request scheduler of the NVMem clients.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The modules sharing the part are the clients of the scheduler,
+ *  listed in NVMEM_SCHED_CLIENTS(X), a table of X(name, class, budget)
+ *  entries which the application may define before including this
+ *  file, and NVMemSched_setClass() may change at run time. Each client
+ *  has a queue of up to NVMEM_SCHED_DEPTH requests, served in order, so
+ *  that requests of different clients may be reordered but the ones of
+ *  a client are not. Clients must not share a range, e.g. each one
+ *  stores in its own region of NVMem_part.h.
+ *
+ *  NVMemSched_dispatch() does a chunk of a request, by means of
+ *  NVMem_readData() or NVMem_storeData(), and calls the done callback of
+ *  the request when it finishes it. A read chunk is up to
+ *  NVMEM_SCHED_CHUNK bytes. A store chunk goes up to the end of its
+ *  NVMEM_SECTOR_SIZE sector, since the driver erases and programs back
+ *  the whole sector when a store sets a bit, once per call. Thus, a
+ *  large request is preempted between its chunks, e.g. a config save
+ *  does not wait for a whole log flush. It is called by the application,
+ *  e.g. from its idle hook, as long as it returns true. Requests are
+ *  submitted from the same context, it is not thread-safe.
+ *
+ *  The next chunk is taken from the head request of the clients,
+ *  ordered by:
+ *
+ *      1. the requests whose deadline is due in NVMEM_SCHED_SLACK us,
+ *         the earliest deadline first,
+ *      2. the clients within their budget of bytes, a budget of 0 being
+ *         unlimited, which is refilled every NVMEM_SCHED_PERIOD us,
+ *      3. the priority class of the client,
+ *      4. the earliest deadline, the requests without deadline last,
+ *      5. the submission order.
+ *
+ *  Therefore a client over its budget is only served when nothing else
+ *  is pending. The deadline of a request is given in us from its
+ *  submission, or NVMEM_SCHED_NO_DEADLINE. NVMemSched_now() returns the
+ *  time in us, it is provided by the platform.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_SCHED_H__
+#define __NVMEM_SCHED_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+/**
+ *  Default table. Config saves are latency-critical, the FFILE_T file
+ *  store flushes large blocks and GStatus is in between.
+ */
+#ifndef NVMEM_SCHED_CLIENTS
+#define NVMEM_SCHED_CLIENTS(X) \
+    X(CONFIG,       NVMEM_SCHED_URGENT, 0) \
+    X(FFILE,        NVMEM_SCHED_BULK,   16 * 1024) \
+    X(GSTATUS,      NVMEM_SCHED_NORMAL, 0)
+#endif
+
+#ifndef NVMEM_SCHED_DEPTH
+#define NVMEM_SCHED_DEPTH           4
+#endif
+
+#ifndef NVMEM_SCHED_CHUNK
+#define NVMEM_SCHED_CHUNK           256
+#endif
+
+#ifndef NVMEM_SCHED_SLACK
+#define NVMEM_SCHED_SLACK           1000
+#endif
+
+#ifndef NVMEM_SCHED_PERIOD
+#define NVMEM_SCHED_PERIOD          1000000
+#endif
+
+#define NVMEM_SCHED_ID(name)        NVMEM_SCHED_ID_##name
+
+#define NVMEM_SCHED_ENUM(name, cls, budget) \
+    NVMEM_SCHED_ID_##name,
+
+/* -------------------------------- Constants ------------------------------ */
+#define NVMEM_SCHED_NO_DEADLINE     0xffffffff
+
+typedef enum NVMemSchedClass NVMemSchedClass;
+enum NVMemSchedClass
+{
+    NVMEM_SCHED_URGENT, NVMEM_SCHED_NORMAL, NVMEM_SCHED_BULK
+};
+
+typedef enum NVMemSchedClient NVMemSchedClient;
+enum NVMemSchedClient
+{
+    NVMEM_SCHED_CLIENTS(NVMEM_SCHED_ENUM)
+    NVMEM_SCHED_NUM_CLIENTS
+};
+
+/* ------------------------------- Data types ------------------------------ */
+typedef void (*NVMemSchedDone)(void *ctx);
+
+typedef struct NVMemSchedStats NVMemSchedStats;
+struct NVMemSchedStats
+{
+    uint32_t depth;             /* requests queued */
+    uint32_t maxDepth;
+    uint32_t nDone;
+    uint32_t nMissed;           /* done after their deadline */
+    uint64_t bytes;
+    uint64_t totalLatency;      /* us, from submission to done */
+    uint32_t maxLatency;        /* us */
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+void NVMemSched_open(void);
+bool NVMemSched_read(NVMemSchedClient client, uint32_t from,
+                     uint32_t nBytes, uint8_t *to, uint32_t deadline,
+                     NVMemSchedDone done, void *ctx);
+bool NVMemSched_store(NVMemSchedClient client, uint32_t to,
+                      uint32_t nBytes, const uint8_t *from,
+                      uint32_t deadline, NVMemSchedDone done, void *ctx);
+bool NVMemSched_dispatch(void);
+void NVMemSched_setClass(NVMemSchedClient client, NVMemSchedClass cls,
+                         uint32_t budget);
+void NVMemSched_getStats(NVMemSchedClient client, NVMemSchedStats *stats);
+void NVMemSched_resetStats(void);
+uint32_t NVMemSched_now(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,122 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_sim.h
+ *  \brief  Specifies the simulated flash NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It provides NVMem_readData() and NVMem_storeData() on top of a flash 
+ *  part simulated in RAM, so that the cost of the stores of a module can 
+ *  be measured on the host.
+ *
+ *  The part is read and programmed in pages of pageSize bytes and erased 
+ *  in sectors of sectorSize bytes. Erasing sets every bit of a sector, 
+ *  programming can only clear them. Every page read or programmed and 
+ *  every sector erased advances the simulated time, given by 
+ *  NVMemSim_now(), by readNs, programNs or eraseNs respectively. A page 
+ *  is programmed as a whole, so storing a single byte costs a page.
+ *
+ *  NVMem_storeData() behaves as the driver of a flash part does: when 
+ *  the new data needs to set a bit, the sector is erased and its former 
+ *  contents merged with the new data are programmed back, otherwise the 
+ *  pages the store touches are programmed. When 'strict' is set, sectors 
+ *  are only erased by NVMemSim_erase(), so a store that needs to set a 
+ *  bit leaves the AND of the old and new data and counts a violation, as 
+ *  the real part would.
+ *
+ *  Write amplification is bytesProgrammed / bytesStored. Reads and 
+ *  stores out of the part behave as in NVMem_mmap.c.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_SIM_H__
+#define __NVMEM_SIM_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+/**
+ *  A 64 KiB part with the geometry and typical timing of a SPI NOR 
+ *  flash.
+ */
+#define NVMEM_SIM_DFT_CFG \
+    { \
+        64 * 1024,      /* size */ \
+        256,            /* pageSize */ \
+        4096,           /* sectorSize */ \
+        5000,           /* readNs */ \
+        700000,         /* programNs */ \
+        45000000,       /* eraseNs */ \
+        false           /* strict */ \
+    }
+
+/* -------------------------------- Constants ------------------------------ */
+#define NVMEM_SIM_ERASED_VALUE  0xff
+
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemSimCfg NVMemSimCfg;
+struct NVMemSimCfg
+{
+    uint32_t size;
+    uint32_t pageSize;
+    uint32_t sectorSize;
+    uint32_t readNs;
+    uint32_t programNs;
+    uint32_t eraseNs;
+    bool strict;
+};
+
+typedef struct NVMemSimStats NVMemSimStats;
+struct NVMemSimStats
+{
+    uint64_t bytesRead;
+    uint64_t bytesStored;
+    uint64_t bytesProgrammed;
+    uint32_t nReads;            /* pages */
+    uint32_t nPrograms;         /* pages */
+    uint32_t nErases;           /* sectors */
+    uint32_t nViolations;
+    uint32_t maxEraseCount;
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool NVMemSim_open(const NVMemSimCfg *cfg);
+void NVMemSim_close(void);
+bool NVMemSim_erase(uint32_t addr);
+uint64_t NVMemSim_now(void);
+uint32_t NVMemSim_eraseCount(uint32_t sector);
+void NVMemSim_getStats(NVMemSimStats *stats);
+void NVMemSim_resetStats(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
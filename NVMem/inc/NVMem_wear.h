@@ -0,0 +1,114 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_wear.h
+ *  \brief  Specifies the wear-leveling layer of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built when NVMEM_WEAR is defined, on top of the device entry
+ *  points NVMemDev_readData() and NVMemDev_storeData().
+ *
+ *  The address space of NVMem_readData() and NVMem_storeData() is split
+ *  into NVMEM_WEAR_BLOCKS logical blocks of NVMEM_SECTOR_SIZE bytes,
+ *  which are mapped onto a pool of NVMEM_WEAR_SECTORS physical sectors,
+ *  so that some sectors are always free and erased. They start at
+ *  NVMEM_WEAR_BASE + 2 sectors, the first two sectors hold the map.
+ *
+ *  A store which only clears bits is programmed in place. Otherwise,
+ *  the block is relocated to the free sector with the lowest erase
+ *  count, copying its former contents merged with the stored bytes, and
+ *  the sector it leaves is erased, so a hot block rotates through the
+ *  free sectors. When a free sector is worn NVMEM_WEAR_DELTA erases
+ *  more than the least worn sector in use, the block of the latter is
+ *  moved to the former, so that cold blocks do not keep the least worn
+ *  sectors to themselves.
+ *
+ *  The map and the erase count of every sector are persisted as a
+ *  record, appended to one of the two map sectors after every
+ *  relocation and before erasing the sector left, so that a reset
+ *  leaves either the former or the new block mapped. A free sector
+ *  found not erased at NVMemWear_open() is erased. NVMemWear_open() is
+ *  called by the first read or store, and again to reload the map.
+ *
+ *  Sectors are erased by storing a whole sector of erased bytes, as the
+ *  driver of the part erases a sector when a store needs to set a bit.
+ */
+
+/* --------------------------------- Module -------------------------------- */
+#ifndef __NVMEM_WEAR_H__
+#define __NVMEM_WEAR_H__
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "NVMem.h"
+#include "NVMem_part.h"
+
+/* ---------------------- External C language linkage ---------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --------------------------------- Macros -------------------------------- */
+#ifndef NVMEM_WEAR_BASE
+#define NVMEM_WEAR_BASE             0
+#endif
+
+/** By default, the regions of the partition table */
+#ifndef NVMEM_WEAR_BLOCKS
+#define NVMEM_WEAR_BLOCKS \
+    ((NVMEM_PART_END + NVMEM_SECTOR_SIZE - 1) / NVMEM_SECTOR_SIZE)
+#endif
+
+/** By default, the whole part but the map sectors */
+#ifndef NVMEM_WEAR_SECTORS
+#define NVMEM_WEAR_SECTORS          ((NVMEM_SIZE / NVMEM_SECTOR_SIZE) - 2)
+#endif
+
+#ifndef NVMEM_WEAR_DELTA
+#define NVMEM_WEAR_DELTA            16
+#endif
+
+/* -------------------------------- Constants ------------------------------ */
+#define NVMEM_WEAR_ERASED_VALUE     0xff
+
+/* ------------------------------- Data types ------------------------------ */
+typedef struct NVMemWearStats NVMemWearStats;
+struct NVMemWearStats
+{
+    uint32_t nRelocations;      /* stores which needed an erase */
+    uint32_t nMigrations;       /* cold blocks moved to worn sectors */
+    uint32_t nMapWrites;
+    uint32_t nMapErases;
+};
+
+/* -------------------------- External variables --------------------------- */
+/* -------------------------- Function prototypes -------------------------- */
+bool NVMemWear_open(void);
+uint32_t NVMemWear_eraseCount(uint32_t sector);
+void NVMemWear_getStats(NVMemWearStats *stats);
+void NVMemWear_resetStats(void);
+
+/* -------------------- External C language linkage end -------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+/* ------------------------------ Module end ------------------------------- */
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
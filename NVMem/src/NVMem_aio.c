@@ -0,0 +1,881 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_aio.c
+ *  \brief  Implements the asynchronous file-backed NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  io_uring is driven through its raw syscalls, so liburing is not
+ *  needed. NVMemAio_submit() only fills a SQE and moves the SQ tail, the
+ *  kernel is entered once per batch by NVMemAio_complete(), or by
+ *  NVMemAio_submit() when the SQ is full. No more than 'depth' requests
+ *  are in flight, so the CQ, twice as large as the SQ, never overflows.
+ *
+ *  The thread pool has the same behaviour as seen from the caller: done
+ *  callbacks are called by NVMemAio_complete(), never by the workers.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include "NVMem_aio.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+#define NUM_WORKERS             4
+#define FILL_CHUNK              4096
+#define VEC_BATCH               16
+
+#define LOAD_ACQ(p)             __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_REL(p, v)         __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Ring Ring;
+struct Ring
+{
+    int fd;
+    unsigned int entries;
+    unsigned int *sqHead;
+    unsigned int *sqTail;
+    unsigned int *sqMask;
+    unsigned int *sqArray;
+    unsigned int *cqHead;
+    unsigned int *cqTail;
+    unsigned int *cqMask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sqMap;
+    void *cqMap;
+    size_t sqMapSize;
+    size_t cqMapSize;
+    unsigned int nQueued;       /* SQEs not submitted yet */
+};
+
+typedef struct Pool Pool;
+struct Pool
+{
+    pthread_t workers[NUM_WORKERS];
+    int nWorkers;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    NVMemAioReq *todo;
+    NVMemAioReq **todoTail;
+    NVMemAioReq *finished;
+    bool stop;
+};
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static int fd = -1;
+static bool usingRing;
+static unsigned int depth;
+static unsigned int nInFlight;
+static NVMemSync policy;
+static uint32_t dirtyFrom;
+static uint32_t dirtyTo;
+static uint8_t *regBuf;
+static size_t regSize;
+static Ring ring;
+static Pool pool =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER
+};
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static int
+ringSetup(unsigned int entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+ringEnter(unsigned int toSubmit, unsigned int minComplete)
+{
+    return (int)syscall(__NR_io_uring_enter, ring.fd, toSubmit, minComplete,
+                        (minComplete != 0) ? IORING_ENTER_GETEVENTS : 0,
+                        NULL, 0);
+}
+
+static int
+ringRegister(unsigned int opcode, void *arg, unsigned int nArgs)
+{
+    return (int)syscall(__NR_io_uring_register, ring.fd, opcode, arg, nArgs);
+}
+
+static bool
+ringSupports(void)
+{
+    struct io_uring_probe *probe;
+    size_t size;
+    bool result;
+
+    size = sizeof(*probe) +
+           (IORING_OP_WRITE + 1) * sizeof(struct io_uring_probe_op);
+    probe = calloc(1, size);
+    if (probe == NULL)
+    {
+        return false;
+    }
+    result = (ringRegister(IORING_REGISTER_PROBE, probe,
+                           IORING_OP_WRITE + 1) == 0) &&
+             (probe->last_op >= IORING_OP_WRITE) &&
+             ((probe->ops[IORING_OP_READ].flags & 
+               IO_URING_OP_SUPPORTED) != 0) &&
+             ((probe->ops[IORING_OP_WRITE].flags & 
+               IO_URING_OP_SUPPORTED) != 0) &&
+             ((probe->ops[IORING_OP_FSYNC].flags & 
+               IO_URING_OP_SUPPORTED) != 0);
+    free(probe);
+    return result;
+}
+
+static void
+ringClose(void)
+{
+    if (ring.sqes != NULL)
+    {
+        munmap(ring.sqes, ring.entries * sizeof(struct io_uring_sqe));
+    }
+    if ((ring.cqMap != NULL) && (ring.cqMap != ring.sqMap))
+    {
+        munmap(ring.cqMap, ring.cqMapSize);
+    }
+    if (ring.sqMap != NULL)
+    {
+        munmap(ring.sqMap, ring.sqMapSize);
+    }
+    if (ring.fd >= 0)
+    {
+        close(ring.fd);
+    }
+    memset(&ring, 0, sizeof(ring));
+    ring.fd = -1;
+}
+
+static bool
+ringOpen(unsigned int entries)
+{
+    struct io_uring_params p;
+    uint8_t *sq, *cq;
+
+    memset(&ring, 0, sizeof(ring));
+    memset(&p, 0, sizeof(p));
+    ring.fd = ringSetup(entries, &p);
+    if (ring.fd < 0)
+    {
+        ring.fd = -1;
+        return false;
+    }
+    ring.entries = p.sq_entries;
+    ring.sqMapSize = p.sq_off.array + (p.sq_entries * sizeof(unsigned int));
+    ring.cqMapSize = p.cq_off.cqes +
+                     (p.cq_entries * sizeof(struct io_uring_cqe));
+    if ((p.features & IORING_FEAT_SINGLE_MMAP) != 0)
+    {
+        ring.sqMapSize = (ring.cqMapSize > ring.sqMapSize) ?
+                         ring.cqMapSize : ring.sqMapSize;
+        ring.cqMapSize = ring.sqMapSize;
+    }
+
+    ring.sqMap = mmap(NULL, ring.sqMapSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    if (ring.sqMap == MAP_FAILED)
+    {
+        ring.sqMap = NULL;
+        ringClose();
+        return false;
+    }
+    ring.cqMap = ((p.features & IORING_FEAT_SINGLE_MMAP) != 0) ?
+                 ring.sqMap :
+                 mmap(NULL, ring.cqMapSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    if (ring.cqMap == MAP_FAILED)
+    {
+        ring.cqMap = NULL;
+        ringClose();
+        return false;
+    }
+    ring.sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+                     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring.fd, IORING_OFF_SQES);
+    if (ring.sqes == MAP_FAILED)
+    {
+        ring.sqes = NULL;
+        ringClose();
+        return false;
+    }
+
+    sq = ring.sqMap;
+    cq = ring.cqMap;
+    ring.sqHead = (unsigned int *)(sq + p.sq_off.head);
+    ring.sqTail = (unsigned int *)(sq + p.sq_off.tail);
+    ring.sqMask = (unsigned int *)(sq + p.sq_off.ring_mask);
+    ring.sqArray = (unsigned int *)(sq + p.sq_off.array);
+    ring.cqHead = (unsigned int *)(cq + p.cq_off.head);
+    ring.cqTail = (unsigned int *)(cq + p.cq_off.tail);
+    ring.cqMask = (unsigned int *)(cq + p.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    if (!ringSupports())
+    {
+        ringClose();
+        return false;
+    }
+    return true;
+}
+
+static void
+ringFlush(unsigned int minComplete)
+{
+    int n;
+
+    do
+    {
+        n = ringEnter(ring.nQueued, minComplete);
+        if (n > 0)
+        {
+            ring.nQueued -= (unsigned int)n;
+        }
+    }
+    while ((n < 0) && (errno == EINTR));
+}
+
+static struct io_uring_sqe *
+ringNext(void)
+{
+    struct io_uring_sqe *sqe;
+    unsigned int tail;
+
+    tail = *ring.sqTail;
+    if ((tail - LOAD_ACQ(ring.sqHead)) == ring.entries)
+    {
+        ringFlush(0);
+    }
+    sqe = &ring.sqes[tail & *ring.sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+static void
+ringPush(void)
+{
+    unsigned int tail, index;
+
+    tail = *ring.sqTail;
+    index = tail & *ring.sqMask;
+    ring.sqArray[index] = index;
+    STORE_REL(ring.sqTail, tail + 1);
+    ++ring.nQueued;
+}
+
+static void
+ringQueue(NVMemAioReq *req)
+{
+    struct io_uring_sqe *sqe;
+    bool fixed;
+
+    sqe = ringNext();
+    fixed = (regBuf != NULL) && (req->buf >= regBuf) &&
+            ((size_t)(req->buf - regBuf) <= regSize) &&
+            (req->nBytes <= (regSize - (size_t)(req->buf - regBuf)));
+    if (req->store)
+    {
+        sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    }
+    else
+    {
+        sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    }
+    sqe->fd = fd;
+    sqe->off = req->addr;
+    sqe->addr = (uintptr_t)req->buf;
+    sqe->len = req->nBytes;
+    sqe->buf_index = 0;
+    sqe->user_data = (uintptr_t)req;
+    ringPush();
+}
+
+static NVMemAioReq *
+ringReap(void)
+{
+    NVMemAioReq *list = NULL, *req;
+    struct io_uring_cqe *cqe;
+    unsigned int head;
+
+    for (head = *ring.cqHead; head != LOAD_ACQ(ring.cqTail); ++head)
+    {
+        cqe = &ring.cqes[head & *ring.cqMask];
+        req = (NVMemAioReq *)(uintptr_t)cqe->user_data;
+        req->result = cqe->res;
+        req->next = list;
+        list = req;
+    }
+    STORE_REL(ring.cqHead, head);
+    return list;
+}
+
+static void *
+worker(void *arg)
+{
+    NVMemAioReq *req;
+    ssize_t n;
+
+    (void)arg;
+    pthread_mutex_lock(&pool.lock);
+    for (;;)
+    {
+        while ((pool.todo == NULL) && !pool.stop)
+        {
+            pthread_cond_wait(&pool.work, &pool.lock);
+        }
+        if (pool.todo == NULL)
+        {
+            break;
+        }
+        req = pool.todo;
+        pool.todo = req->next;
+        if (pool.todo == NULL)
+        {
+            pool.todoTail = &pool.todo;
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        n = req->store ? pwrite(fd, req->buf, req->nBytes, req->addr) :
+                         pread(fd, req->buf, req->nBytes, req->addr);
+        req->result = (n < 0) ? -errno : (int)n;
+
+        pthread_mutex_lock(&pool.lock);
+        req->next = pool.finished;
+        pool.finished = req;
+        pthread_cond_signal(&pool.done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+static bool
+poolOpen(void)
+{
+    pool.todo = pool.finished = NULL;
+    pool.todoTail = &pool.todo;
+    pool.stop = false;
+    for (pool.nWorkers = 0; pool.nWorkers < NUM_WORKERS; ++pool.nWorkers)
+    {
+        if (pthread_create(&pool.workers[pool.nWorkers], NULL, worker, 
+                           NULL) != 0)
+        {
+            break;
+        }
+    }
+    return pool.nWorkers != 0;
+}
+
+static void
+poolClose(void)
+{
+    int i;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.stop = true;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+    for (i = 0; i < pool.nWorkers; ++i)
+    {
+        pthread_join(pool.workers[i], NULL);
+    }
+    pool.nWorkers = 0;
+}
+
+static void
+poolQueue(NVMemAioReq *req)
+{
+    pthread_mutex_lock(&pool.lock);
+    req->next = NULL;
+    *pool.todoTail = req;
+    pool.todoTail = &req->next;
+    pthread_cond_signal(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static NVMemAioReq *
+poolReap(bool wait)
+{
+    NVMemAioReq *list;
+
+    pthread_mutex_lock(&pool.lock);
+    while (wait && (pool.finished == NULL))
+    {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    list = pool.finished;
+    pool.finished = NULL;
+    pthread_mutex_unlock(&pool.lock);
+    return list;
+}
+
+static void
+markDirty(uint32_t from, uint32_t to)
+{
+    if (dirtyFrom == dirtyTo)
+    {
+        dirtyFrom = from;
+        dirtyTo = to;
+    }
+    else
+    {
+        dirtyFrom = (from < dirtyFrom) ? from : dirtyFrom;
+        dirtyTo = (to > dirtyTo) ? to : dirtyTo;
+    }
+}
+
+/*
+ *  Turns the byte count of a transfer into req->result. A short read
+ *  is past the end of the file, so the rest is erased.
+ */
+static void
+finish(NVMemAioReq *req)
+{
+    if (req->result < 0)
+    {
+        return;
+    }
+    if ((uint32_t)req->result < req->nBytes)
+    {
+        if (req->store)
+        {
+            req->result = -EIO;
+            return;
+        }
+        memset(req->buf + req->result, NVMEM_AIO_ERASED_VALUE,
+               req->nBytes - req->result);
+    }
+    if (req->store && (req->nBytes != 0))
+    {
+        markDirty(req->addr, req->addr + req->nBytes);
+    }
+    req->result = 0;
+}
+
+static bool
+eraseTail(off_t from, off_t to)
+{
+    uint8_t erased[FILL_CHUNK];
+    size_t chunk;
+
+    memset(erased, NVMEM_AIO_ERASED_VALUE, sizeof(erased));
+    for (; from < to; from += chunk)
+    {
+        chunk = ((to - from) < FILL_CHUNK) ? (size_t)(to - from) : FILL_CHUNK;
+        if (pwrite(fd, erased, chunk, from) != (ssize_t)chunk)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void
+syncDone(NVMemAioReq *req)
+{
+    *(bool *)req->ctx = true;
+}
+
+/*
+ *  Waits for the data of the range to reach the disk. The ring does it
+ *  by a ranged IORING_OP_FSYNC, which carries no bytes, so finish()
+ *  leaves its result alone.
+ */
+static bool
+syncRange(uint32_t from, uint32_t to)
+{
+    struct io_uring_sqe *sqe;
+    NVMemAioReq req;
+    bool done = false;
+
+    if (from == to)
+    {
+        return true;
+    }
+    if (!usingRing)
+    {
+        return fdatasync(fd) == 0;
+    }
+
+    while (nInFlight == depth)
+    {
+        NVMemAio_complete(true);
+    }
+    ++nInFlight;
+    memset(&req, 0, sizeof(req));
+    req.store = true;
+    req.done = syncDone;
+    req.ctx = &done;
+    sqe = ringNext();
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    sqe->off = from;
+    sqe->len = to - from;
+    sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe->user_data = (uintptr_t)&req;
+    ringPush();
+    while (!done)
+    {
+        NVMemAio_complete(true);
+    }
+    return req.result == 0;
+}
+
+/*
+ *  Applies the sync policy once a synchronous store is done. A range
+ *  which fails to be synchronized stays dirty, so that the next sync
+ *  retries it.
+ */
+static void
+stored(void)
+{
+    switch (policy)
+    {
+        case NVMEM_SYNC_IMMEDIATE:
+            if (fsync(fd) == 0)
+            {
+                dirtyFrom = dirtyTo = 0;
+            }
+            break;
+        case NVMEM_SYNC_RANGED:
+            NVMemAio_sync();
+            break;
+        default:
+            break;
+    }
+}
+
+static int
+transfer(uint32_t addr, uint32_t nBytes, uint8_t *buf, bool store)
+{
+    NVMemAioReq req;
+    bool done = false;
+
+    if (fd < 0)
+    {
+        return -EBADF;
+    }
+    req.addr = addr;
+    req.nBytes = nBytes;
+    req.buf = buf;
+    req.store = store;
+    req.done = syncDone;
+    req.ctx = &done;
+    NVMemAio_submit(&req);
+    while (!done)
+    {
+        NVMemAio_complete(true);
+    }
+    return req.result;
+}
+
+#if NVMEM_VECTORED_BY_DEV == 1
+static void
+vecDone(NVMemAioReq *req)
+{
+    ++*(uint32_t *)req->ctx;
+}
+
+/*
+ *  Submits the segments in batches of VEC_BATCH requests, so that they
+ *  go to the kernel at once, and waits for every batch. Returns false
+ *  when any of them failed.
+ */
+static bool
+transferv(const NVMemSeg *segs, uint32_t nSegs, bool store)
+{
+    NVMemAioReq reqs[VEC_BATCH];
+    uint32_t i, n, nDone;
+    bool result = true;
+
+    for (; nSegs != 0; nSegs -= n, segs += n)
+    {
+        n = (nSegs < VEC_BATCH) ? nSegs : VEC_BATCH;
+        nDone = 0;
+        for (i = 0; i < n; ++i)
+        {
+            reqs[i].addr = segs[i].addr;
+            reqs[i].nBytes = segs[i].nBytes;
+            reqs[i].buf = segs[i].buf;
+            reqs[i].store = store;
+            reqs[i].done = vecDone;
+            reqs[i].ctx = &nDone;
+            reqs[i].result = (fd < 0) ? -EBADF : 0;
+            if (fd >= 0)
+            {
+                NVMemAio_submit(&reqs[i]);
+            }
+            else
+            {
+                ++nDone;
+            }
+        }
+        while (nDone != n)
+        {
+            NVMemAio_complete(true);
+        }
+        for (i = 0; i < n; ++i)
+        {
+            if (reqs[i].result == 0)
+            {
+                continue;
+            }
+            result = false;
+            if (!store)
+            {
+                memset(segs[i].buf, NVMEM_AIO_ERASED_VALUE, segs[i].nBytes);
+            }
+        }
+    }
+    return result;
+}
+#endif
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+NVMemAio_open(const char *path, uint32_t size, unsigned int nDepth,
+              NVMemAioMode mode, NVMemSync syncPolicy)
+{
+    struct stat st;
+
+    NVMemAio_close();
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if ((fstat(fd, &st) != 0) ||
+        (S_ISREG(st.st_mode) && (st.st_size < size) &&
+         !eraseTail(st.st_size, size)))
+    {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    depth = (nDepth == 0) ? 1 : nDepth;
+    nInFlight = 0;
+    policy = syncPolicy;
+    dirtyFrom = dirtyTo = 0;
+    usingRing = (mode == NVMEM_AIO_AUTO) && ringOpen(depth);
+    if (usingRing)
+    {
+        depth = (depth < ring.entries) ? depth : ring.entries;
+    }
+    else if (!poolOpen())
+    {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void
+NVMemAio_close(void)
+{
+    if (fd < 0)
+    {
+        return;
+    }
+    while (nInFlight != 0)
+    {
+        NVMemAio_complete(true);
+    }
+    NVMemAio_sync();
+    if (usingRing)
+    {
+        ringClose();
+    }
+    else
+    {
+        poolClose();
+    }
+    fsync(fd);
+    close(fd);
+    fd = -1;
+    regBuf = NULL;
+    regSize = 0;
+}
+
+/*
+ *  The range is taken before the sync is submitted, so the stores which
+ *  complete while waiting for it stay dirty.
+ */
+bool
+NVMemAio_sync(void)
+{
+    uint32_t from, to;
+
+    if (fd < 0)
+    {
+        return false;
+    }
+    from = dirtyFrom;
+    to = dirtyTo;
+    dirtyFrom = dirtyTo = 0;
+    if (!syncRange(from, to))
+    {
+        markDirty(from, to);
+        return false;
+    }
+    return true;
+}
+
+bool
+NVMemAio_usingRing(void)
+{
+    return (fd >= 0) && usingRing;
+}
+
+/**
+ *  Without io_uring there is nothing to register, so it always succeeds.
+ */
+bool
+NVMemAio_register(uint8_t *buf, size_t nBytes)
+{
+    struct iovec iov;
+
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (usingRing)
+    {
+        if (regBuf != NULL)
+        {
+            ringRegister(IORING_UNREGISTER_BUFFERS, NULL, 0);
+            regBuf = NULL;
+            regSize = 0;
+        }
+        iov.iov_base = buf;
+        iov.iov_len = nBytes;
+        if (ringRegister(IORING_REGISTER_BUFFERS, &iov, 1) != 0)
+        {
+            return false;
+        }
+    }
+    regBuf = buf;
+    regSize = nBytes;
+    return true;
+}
+
+void
+NVMemAio_submit(NVMemAioReq *req)
+{
+    while (nInFlight == depth)
+    {
+        NVMemAio_complete(true);
+    }
+    ++nInFlight;
+    if (usingRing)
+    {
+        ringQueue(req);
+    }
+    else
+    {
+        poolQueue(req);
+    }
+}
+
+unsigned int
+NVMemAio_complete(bool wait)
+{
+    NVMemAioReq *list, *req;
+    unsigned int n;
+
+    wait = wait && (nInFlight != 0);
+    if (usingRing)
+    {
+        if ((ring.nQueued != 0) || wait)
+        {
+            ringFlush(wait ? 1 : 0);
+        }
+        list = ringReap();
+    }
+    else
+    {
+        list = poolReap(wait);
+    }
+
+    for (n = 0; list != NULL; ++n)
+    {
+        req = list;
+        list = req->next;
+        --nInFlight;
+        finish(req);
+        if (req->done != NULL)
+        {
+            req->done(req);
+        }
+    }
+    return n;
+}
+
+void
+NVMEM_DEV_READ(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    if (transfer(from, nBytes, to, false) != 0)
+    {
+        memset(to, NVMEM_AIO_ERASED_VALUE, nBytes);
+    }
+}
+
+void
+NVMEM_DEV_STORE(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    if (transfer(to, nBytes, (uint8_t *)from, true) == 0)
+    {
+        stored();
+    }
+}
+
+#if NVMEM_VECTORED_BY_DEV == 1
+void
+NVMem_readv(const NVMemSeg *segs, uint32_t nSegs)
+{
+    transferv(segs, nSegs, false);
+}
+
+void
+NVMem_writev(const NVMemSeg *segs, uint32_t nSegs)
+{
+    if (transferv(segs, nSegs, true))
+    {
+        stored();
+    }
+}
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
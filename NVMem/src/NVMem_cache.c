@@ -0,0 +1,299 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_cache.c
+ *  \brief  Implements the read cache and write-back buffer of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The cache is fully associative, lines are looked up linearly, as there
+ *  are a few of them. A line is valid only when all of its bytes are, so
+ *  a store which covers a whole line does not fill it from the device,
+ *  unless NVMEM_ELIDE needs its bytes to compare them. The chunk of a
+ *  store which matches the bytes of its line leaves the line clean.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include <stdbool.h>
+#include "NVMem_cache.h"
+
+#if defined(NVMEM_CACHE)
+
+/* ----------------------------- Local macros ------------------------------ */
+#define LINE_BASE(addr)         ((addr) - ((addr) % NVMEM_CACHE_LINE))
+
+#if defined(NVMEM_ELIDE)
+#define FILL_WHOLE_LINE         true
+#else
+#define FILL_WHOLE_LINE         false
+#endif
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Line Line;
+struct Line
+{
+    uint32_t base;
+    uint32_t lastUse;
+    bool valid;
+    bool dirty;
+    uint8_t data[NVMEM_CACHE_LINE];
+};
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static Line lines[NVMEM_CACHE_LINES];
+static uint8_t burst[NVMEM_CACHE_BURST_LINES * NVMEM_CACHE_LINE];
+static uint32_t useCount;
+static uint32_t nDirty;
+static NVMemCacheStats stats;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+writeBack(Line *line)
+{
+    NVMemDev_storeData(line->base, NVMEM_CACHE_LINE, line->data);
+    line->dirty = false;
+    --nDirty;
+    ++stats.nBursts;
+    stats.bytesWritten += NVMEM_CACHE_LINE;
+}
+
+static Line *
+lookup(uint32_t base)
+{
+    Line *line;
+
+    for (line = lines; line < &lines[NVMEM_CACHE_LINES]; ++line)
+    {
+        if (line->valid && (line->base == base))
+        {
+            return line;
+        }
+    }
+    return (Line *)0;
+}
+
+/*
+ *  Returns the line at base, replacing the least recently used one when
+ *  it is not cached. The new line is filled from the device unless the
+ *  caller is going to overwrite it as a whole.
+ */
+static Line *
+getLine(uint32_t base, bool fill)
+{
+    Line *line, *victim;
+
+    line = lookup(base);
+    if (line != (Line *)0)
+    {
+        ++stats.nHits;
+    }
+    else
+    {
+        ++stats.nMisses;
+        victim = lines;
+        for (line = lines; line < &lines[NVMEM_CACHE_LINES]; ++line)
+        {
+            if (!line->valid)
+            {
+                victim = line;
+                break;
+            }
+            if (line->lastUse < victim->lastUse)
+            {
+                victim = line;
+            }
+        }
+        line = victim;
+        if (line->valid && line->dirty)
+        {
+            writeBack(line);
+        }
+        line->base = base;
+        line->valid = true;
+        line->dirty = false;
+        if (fill)
+        {
+            NVMemDev_readData(base, NVMEM_CACHE_LINE, line->data);
+        }
+    }
+    line->lastUse = ++useCount;
+    return line;
+}
+
+/*
+ *  Returns the dirty line with the lowest base above 'after', or
+ *  the lowest one at all when first is true.
+ */
+static Line *
+nextDirty(uint32_t after, bool first)
+{
+    Line *line, *next = (Line *)0;
+
+    for (line = lines; line < &lines[NVMEM_CACHE_LINES]; ++line)
+    {
+        if (line->valid && line->dirty && (first || (line->base > after)) &&
+            ((next == (Line *)0) || (line->base < next->base)))
+        {
+            next = line;
+        }
+    }
+    return next;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+NVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    Line *line;
+    uint32_t base, offset, chunk;
+
+    if (nBytes >= NVMEM_CACHE_BYPASS)
+    {
+        NVMemDev_readData(from, nBytes, to);
+        for (line = lines; line < &lines[NVMEM_CACHE_LINES]; ++line)
+        {
+            if (line->valid && ((line->base + NVMEM_CACHE_LINE) > from) &&
+                (line->base < (from + nBytes)))
+            {
+                offset = (line->base > from) ? 0 : from - line->base;
+                base = line->base + offset;
+                chunk = NVMEM_CACHE_LINE - offset;
+                chunk = ((base + chunk) > (from + nBytes)) ?
+                        (from + nBytes) - base : chunk;
+                memcpy(to + (base - from), line->data + offset, chunk);
+            }
+        }
+        return;
+    }
+
+    for (; nBytes != 0; nBytes -= chunk, from += chunk, to += chunk)
+    {
+        base = LINE_BASE(from);
+        offset = from - base;
+        chunk = NVMEM_CACHE_LINE - offset;
+        chunk = (nBytes < chunk) ? nBytes : chunk;
+        line = getLine(base, true);
+        memcpy(to, line->data + offset, chunk);
+    }
+}
+
+void
+NVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    Line *line;
+    uint32_t base, offset, chunk;
+    bool known;
+
+    stats.bytesStored += nBytes;
+    for (; nBytes != 0; nBytes -= chunk, to += chunk, from += chunk)
+    {
+        base = LINE_BASE(to);
+        offset = to - base;
+        chunk = NVMEM_CACHE_LINE - offset;
+        chunk = (nBytes < chunk) ? nBytes : chunk;
+        known = (chunk != NVMEM_CACHE_LINE) || FILL_WHOLE_LINE ||
+                (lookup(base) != (Line *)0);
+        line = getLine(base, known);
+        if (known && (memcmp(line->data + offset, from, chunk) == 0))
+        {
+            stats.bytesElided += chunk;
+            continue;
+        }
+        memcpy(line->data + offset, from, chunk);
+        if (!line->dirty)
+        {
+            line->dirty = true;
+            ++nDirty;
+        }
+    }
+    if (nDirty >= NVMEM_CACHE_DIRTY_MAX)
+    {
+        NVMem_flush();
+    }
+}
+
+void
+NVMem_flush(void)
+{
+    Line *line;
+    uint32_t base, nLines;
+
+    for (line = nextDirty(0, true); line != (Line *)0; )
+    {
+        base = line->base;
+        nLines = 0;
+        do
+        {
+            memcpy(&burst[nLines * NVMEM_CACHE_LINE], line->data,
+                   NVMEM_CACHE_LINE);
+            line->dirty = false;
+            --nDirty;
+            ++nLines;
+            line = nextDirty(line->base, false);
+        }
+        while ((line != (Line *)0) && (nLines < NVMEM_CACHE_BURST_LINES) &&
+               (line->base == (base + (nLines * NVMEM_CACHE_LINE))));
+
+        NVMemDev_storeData(base, nLines * NVMEM_CACHE_LINE, burst);
+        ++stats.nBursts;
+        stats.bytesWritten += nLines * NVMEM_CACHE_LINE;
+    }
+}
+
+void
+NVMemCache_invalidate(void)
+{
+    Line *line;
+
+    NVMem_flush();
+    for (line = lines; line < &lines[NVMEM_CACHE_LINES]; ++line)
+    {
+        line->valid = false;
+    }
+}
+
+void
+NVMemCache_getStats(NVMemCacheStats *result)
+{
+    *result = stats;
+}
+
+void
+NVMemCache_resetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void
+NVMem_getStats(NVMemStats *result)
+{
+    result->bytesStored = stats.bytesStored;
+    result->bytesElided = stats.bytesElided;
+}
+
+void
+NVMem_resetStats(void)
+{
+    NVMemCache_resetStats();
+}
+
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,216 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_eeprom.c
+ *  \brief  Implements the page-aware serial EEPROM back-end of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The bytes to be written to a page are gathered in pageBuf, from lo up
+ *  to hi, until a store touches another page or ends. When the bytes
+ *  between two segments can not be read, the page is dropped rather
+ *  than written with made-up bytes, and so are the rest of its segments.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "NVMem_eeprom.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+#define MIN(a, b)               (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)               (((a) > (b)) ? (a) : (b))
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint8_t pageBuf[NVMEM_EEPROM_PAGE];
+static uint32_t pageBase;
+static uint32_t lo;
+static uint32_t hi;
+static bool pending;
+static bool dropped;
+static uint32_t droppedBase;
+static bool busy;
+static NVMemEepromStats stats;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static bool
+waitReady(void)
+{
+    uint32_t nPolls;
+
+    for (nPolls = 0; busy && !NVMemEeprom_busReady(); ++nPolls)
+    {
+        ++stats.nPolls;
+        if (nPolls == NVMEM_EEPROM_POLL_MAX)
+        {
+            ++stats.nTimeouts;
+            return false;
+        }
+    }
+    busy = false;
+    return true;
+}
+
+static bool
+readPart(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    if (waitReady() && NVMemEeprom_busRead(from, nBytes, to))
+    {
+        return true;
+    }
+    memset(to, NVMEM_EEPROM_ERASED_VALUE, nBytes);
+    return false;
+}
+
+static void
+dropPage(uint32_t base)
+{
+    pending = false;
+    dropped = true;
+    droppedBase = base;
+    ++stats.nDropped;
+}
+
+static void
+writePage(void)
+{
+    if (!pending)
+    {
+        return;
+    }
+    if (waitReady() &&
+        NVMemEeprom_busWrite(pageBase + lo, hi - lo, &pageBuf[lo]))
+    {
+        busy = true;
+        ++stats.nPageWrites;
+    }
+    else
+    {
+        ++stats.nDropped;
+    }
+    pending = false;
+}
+
+/*
+ *  Reads the bytes of the gathered page from 'from' up to 'to'.
+ */
+static bool
+fill(uint32_t from, uint32_t to)
+{
+    if (!readPart(pageBase + from, to - from, &pageBuf[from]))
+    {
+        return false;
+    }
+    stats.bytesFilled += to - from;
+    return true;
+}
+
+/*
+ *  Gathers a store into the pages to be written, writing the gathered
+ *  page when the store goes on in another one.
+ */
+static void
+gather(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    uint32_t base, off, n;
+
+    stats.bytesStored += nBytes;
+    for (; nBytes != 0; nBytes -= n, to += n, from += n)
+    {
+        base = to - (to % NVMEM_EEPROM_PAGE);
+        off = to - base;
+        n = MIN(nBytes, NVMEM_EEPROM_PAGE - off);
+        if (dropped && (base == droppedBase))
+        {
+            continue;
+        }
+        dropped = false;
+        if (pending && (base != pageBase))
+        {
+            writePage();
+        }
+        if (!pending)
+        {
+            pageBase = base;
+            lo = off;
+            hi = off;
+            pending = true;
+        }
+        if (((off > hi) && !fill(hi, off)) ||
+            (((off + n) < lo) && !fill(off + n, lo)))
+        {
+            dropPage(base);
+            continue;
+        }
+        memcpy(&pageBuf[off], from, n);
+        lo = MIN(lo, off);
+        hi = MAX(hi, off + n);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+NVMemEeprom_getStats(NVMemEepromStats *result)
+{
+    *result = stats;
+}
+
+void
+NVMemEeprom_resetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void
+NVMEM_DEV_READ(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    readPart(from, nBytes, to);
+}
+
+void
+NVMEM_DEV_STORE(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    dropped = false;
+    gather(to, nBytes, from);
+    writePage();
+}
+
+#if NVMEM_VECTORED_BY_DEV == 1
+void
+NVMem_readv(const NVMemSeg *segs, uint32_t nSegs)
+{
+    for (; nSegs != 0; --nSegs, ++segs)
+    {
+        readPart(segs->addr, segs->nBytes, segs->buf);
+    }
+}
+
+void
+NVMem_writev(const NVMemSeg *segs, uint32_t nSegs)
+{
+    dropped = false;
+    for (; nSegs != 0; --nSegs, ++segs)
+    {
+        gather(segs->addr, segs->nBytes, segs->buf);
+    }
+    writePage();
+}
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
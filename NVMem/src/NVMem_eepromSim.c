@@ -0,0 +1,182 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_eepromSim.c
+ *  \brief  Implements the simulated serial EEPROM on the host.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/* ----------------------------- Include files ----------------------------- */
+#include <stdlib.h>
+#include <string.h>
+#include "NVMem_eepromSim.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemEepromSimCfg cfg;
+static NVMemEepromSimStats stats;
+static uint64_t now;
+static uint64_t busyUntil;
+static uint32_t nNacks;
+static uint8_t *cells;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static bool
+inPart(uint32_t addr, uint32_t nBytes)
+{
+    return (cells != (uint8_t *)0) && (addr <= cfg.size) &&
+           (nBytes <= (cfg.size - addr));
+}
+
+/*
+ *  Clocks a transaction of nBytes through the bus and returns whether
+ *  the part acknowledged it.
+ */
+static bool
+transaction(uint32_t nBytes)
+{
+    bool isBusy;
+
+    isBusy = now < busyUntil;
+    now += (uint64_t)nBytes * cfg.byteNs;
+    return !isBusy;
+}
+
+static bool
+nacked(void)
+{
+    if (nNacks == 0)
+    {
+        return false;
+    }
+    --nNacks;
+    return true;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+NVMemEepromSim_open(const NVMemEepromSimCfg *config)
+{
+    NVMemEepromSim_close();
+    if ((config->pageSize == 0) || (config->size == 0) ||
+        ((config->size % config->pageSize) != 0))
+    {
+        return false;
+    }
+
+    cfg = *config;
+    cells = malloc(cfg.size);
+    if (cells == (uint8_t *)0)
+    {
+        return false;
+    }
+    memset(cells, NVMEM_EEPROM_ERASED_VALUE, cfg.size);
+    memset(&stats, 0, sizeof(stats));
+    now = busyUntil = 0;
+    nNacks = 0;
+    return true;
+}
+
+void
+NVMemEepromSim_close(void)
+{
+    free(cells);
+    cells = (uint8_t *)0;
+}
+
+uint64_t
+NVMemEepromSim_now(void)
+{
+    return now;
+}
+
+void
+NVMemEepromSim_wait(uint64_t ns)
+{
+    now += ns;
+}
+
+void
+NVMemEepromSim_nack(uint32_t nTransactions)
+{
+    nNacks = nTransactions;
+}
+
+void
+NVMemEepromSim_getStats(NVMemEepromSimStats *result)
+{
+    *result = stats;
+}
+
+void
+NVMemEepromSim_resetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool
+NVMemEeprom_busRead(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    if (!transaction(cfg.cmdBytes + nBytes) || !inPart(from, nBytes))
+    {
+        ++stats.nViolations;
+        return false;
+    }
+    if (nacked())
+    {
+        return false;
+    }
+    memcpy(to, cells + from, nBytes);
+    stats.bytesRead += nBytes;
+    return true;
+}
+
+bool
+NVMemEeprom_busWrite(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    uint32_t base, i;
+
+    if (!transaction(cfg.cmdBytes + nBytes) || !inPart(to, 1))
+    {
+        ++stats.nViolations;
+        return false;
+    }
+    if (nacked())
+    {
+        return false;
+    }
+    base = to - (to % cfg.pageSize);
+    for (i = 0; i < nBytes; ++i)
+    {
+        cells[base + ((to - base + i) % cfg.pageSize)] = from[i];
+    }
+    busyUntil = now + cfg.writeNs;
+    ++stats.nPageWrites;
+    stats.bytesWritten += nBytes;
+    return true;
+}
+
+bool
+NVMemEeprom_busReady(void)
+{
+    ++stats.nPolls;
+    return transaction(cfg.pollBytes);
+}
+
+/* ------------------------------ End of file ------------------------------ */
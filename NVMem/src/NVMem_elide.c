@@ -0,0 +1,102 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_elide.c
+ *  \brief  Implements the write elision of NVMem by reading back.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built with NVMEM_ELIDE and without NVMEM_CACHE, as the cache
+ *  elides stores by itself. A store is split into chunks of
+ *  NVMEM_ELIDE_CHUNK bytes, aligned to their size, which should be the
+ *  page size of the device. Every chunk is read back and compared, and
+ *  the consecutive changed chunks are stored by a single device store.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "NVMem.h"
+
+#if defined(NVMEM_ELIDE) && !defined(NVMEM_CACHE)
+
+/* ----------------------------- Local macros ------------------------------ */
+#ifndef NVMEM_ELIDE_CHUNK
+#define NVMEM_ELIDE_CHUNK       64
+#endif
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint8_t stored[NVMEM_ELIDE_CHUNK];
+static NVMemStats stats;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+/* ---------------------------- Global functions --------------------------- */
+void
+NVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    NVMemDev_readData(from, nBytes, to);
+}
+
+void
+NVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    uint32_t chunk, runLen;
+    const uint8_t *run;
+
+    stats.bytesStored += nBytes;
+    for (run = from, runLen = 0; nBytes != 0;
+         nBytes -= chunk, to += chunk, from += chunk)
+    {
+        chunk = NVMEM_ELIDE_CHUNK - (to % NVMEM_ELIDE_CHUNK);
+        chunk = (nBytes < chunk) ? nBytes : chunk;
+        NVMemDev_readData(to, chunk, stored);
+        if (memcmp(stored, from, chunk) != 0)
+        {
+            runLen += chunk;
+            continue;
+        }
+        stats.bytesElided += chunk;
+        if (runLen != 0)
+        {
+            NVMemDev_storeData(to - runLen, runLen, run);
+        }
+        run = from + chunk;
+        runLen = 0;
+    }
+    if (runLen != 0)
+    {
+        NVMemDev_storeData(to - runLen, runLen, run);
+    }
+}
+
+void
+NVMem_getStats(NVMemStats *result)
+{
+    *result = stats;
+}
+
+void
+NVMem_resetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
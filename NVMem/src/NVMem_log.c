@@ -0,0 +1,391 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_log.c
+ *  \brief  Implements the log-structured record store on top of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  A record is laid out as
+ *
+ *      crc | seq | id | len | payload
+ *
+ *  where the CRC covers everything after it, and it is padded with
+ *  erased bytes to a multiple of REC_ALIGN. A record header left erased
+ *  ends the records of a sector. Before appending a record, its bytes
+ *  are checked to be erased, so that bytes programmed by a torn store
+ *  are never programmed again, which would erase the whole sector.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "NVMem_log.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+#define SECTOR_ADDR(s)          (base + ((s) * NVMEM_SECTOR_SIZE))
+#define IN_SECTOR(addr, s) \
+    (((addr) >= SECTOR_ADDR(s)) && \
+     ((addr) < (SECTOR_ADDR(s) + NVMEM_SECTOR_SIZE)))
+#define REC_SIZE(len) \
+    ((((REC_HDR_SIZE + (len)) + REC_ALIGN - 1) / REC_ALIGN) * REC_ALIGN)
+
+/* ------------------------------- Constants ------------------------------- */
+#define SECTOR_MAGIC            0x474f4c4eUL
+#define SECTOR_HDR_SIZE         12
+#define REC_HDR_SIZE            12
+#define REC_ALIGN               4
+#define CHECK_CHUNK             64
+
+_Static_assert((NVMEM_LOG_MAX_IDS * REC_SIZE(NVMEM_LOG_MAX_LEN)) <=
+               (NVMEM_SECTOR_SIZE - SECTOR_HDR_SIZE),
+               "NVMem log records do not fit in a sector");
+
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Entry Entry;
+struct Entry
+{
+    uint32_t addr;
+    uint32_t seq;
+    uint16_t len;
+    bool valid;
+};
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint32_t base;
+static uint32_t ringSize;
+static uint32_t head;           /* sector being filled */
+static uint32_t headOff;
+static uint32_t tail;           /* oldest sector */
+static uint32_t nextSeq;
+static uint32_t nextSectorSeq;
+static bool isOpen;
+static bool used[NVMEM_LOG_MAX_SECTORS];
+static Entry entries[NVMEM_LOG_MAX_IDS];
+static uint8_t rec[REC_HDR_SIZE + NVMEM_LOG_MAX_LEN];
+static uint8_t chunk[CHECK_CHUNK];
+static uint8_t erased[NVMEM_SECTOR_SIZE];
+static NVMemLogStats stats;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static uint32_t
+next(uint32_t sector)
+{
+    return (sector + 1) % ringSize;
+}
+
+static bool
+isErasedAt(uint32_t addr, uint32_t nBytes)
+{
+    uint32_t n;
+
+    for (; nBytes != 0; nBytes -= n, addr += n)
+    {
+        n = (nBytes < CHECK_CHUNK) ? nBytes : CHECK_CHUNK;
+        NVMem_readData(addr, n, chunk);
+        if (memcmp(chunk, erased, n) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ *  The sector is stored as a whole, as the driver programs back the
+ *  bytes of the sector out of a store when it erases it.
+ */
+static void
+eraseSector(uint32_t sector)
+{
+    if (!isErasedAt(SECTOR_ADDR(sector), NVMEM_SECTOR_SIZE))
+    {
+        NVMem_storeData(SECTOR_ADDR(sector), NVMEM_SECTOR_SIZE, erased);
+    }
+    used[sector] = false;
+}
+
+static bool
+readSectorHdr(uint32_t sector, uint32_t *seq)
+{
+    uint8_t hdr[SECTOR_HDR_SIZE];
+    uint32_t magic, crc;
+
+    NVMem_readData(SECTOR_ADDR(sector), SECTOR_HDR_SIZE, hdr);
+    memcpy(&magic, &hdr[0], 4);
+    memcpy(seq, &hdr[4], 4);
+    memcpy(&crc, &hdr[8], 4);
+    return (magic == SECTOR_MAGIC) &&
+           (crc == Crc32_calc8(hdr, 0xffffffff));
+}
+
+static void
+startSector(uint32_t sector)
+{
+    uint8_t hdr[SECTOR_HDR_SIZE];
+    uint32_t magic, crc;
+
+    magic = SECTOR_MAGIC;
+    memcpy(&hdr[0], &magic, 4);
+    memcpy(&hdr[4], &nextSectorSeq, 4);
+    crc = Crc32_calc8(hdr, 0xffffffff);
+    memcpy(&hdr[8], &crc, 4);
+    NVMem_storeData(SECTOR_ADDR(sector), SECTOR_HDR_SIZE, hdr);
+    ++nextSectorSeq;
+    used[sector] = true;
+    head = sector;
+    headOff = SECTOR_HDR_SIZE;
+    stats.bytesAppended += SECTOR_HDR_SIZE;
+}
+
+static void
+indexRecord(uint16_t id, uint32_t seq, uint32_t addr, uint16_t len)
+{
+    Entry *entry;
+
+    entry = &entries[id];
+    if (!entry->valid || (seq >= entry->seq))
+    {
+        entry->addr = addr;
+        entry->seq = seq;
+        entry->len = len;
+        entry->valid = true;
+    }
+    if (seq >= nextSeq)
+    {
+        nextSeq = seq + 1;
+    }
+}
+
+/*
+ *  Indexes the valid records of a sector and returns the offset of the
+ *  first erased record header, or the sector size when a corrupt length
+ *  leaves no way to find it.
+ */
+static uint32_t
+scanSector(uint32_t sector)
+{
+    uint32_t off, addr, crc, seq;
+    uint16_t id, len;
+
+    for (off = SECTOR_HDR_SIZE;
+         (off + REC_HDR_SIZE) <= NVMEM_SECTOR_SIZE;
+         off += REC_SIZE(len))
+    {
+        addr = SECTOR_ADDR(sector) + off;
+        NVMem_readData(addr, REC_HDR_SIZE, rec);
+        if (memcmp(rec, erased, REC_HDR_SIZE) == 0)
+        {
+            return off;
+        }
+        memcpy(&crc, &rec[0], 4);
+        memcpy(&seq, &rec[4], 4);
+        memcpy(&id, &rec[8], 2);
+        memcpy(&len, &rec[10], 2);
+        if ((len > NVMEM_LOG_MAX_LEN) ||
+            ((off + REC_SIZE(len)) > NVMEM_SECTOR_SIZE))
+        {
+            break;
+        }
+        NVMem_readData(addr + REC_HDR_SIZE, len, &rec[REC_HDR_SIZE]);
+        if ((id < NVMEM_LOG_MAX_IDS) &&
+            (crc == Crc32_calc(&rec[4], REC_HDR_SIZE - 4 + len, 0xffffffff)))
+        {
+            indexRecord(id, seq, addr, len);
+        }
+    }
+    return NVMEM_SECTOR_SIZE;
+}
+
+static bool
+hasRoom(uint16_t len)
+{
+    uint32_t size;
+
+    size = REC_SIZE(len);
+    return ((headOff + size) <= NVMEM_SECTOR_SIZE) &&
+           isErasedAt(SECTOR_ADDR(head) + headOff, size);
+}
+
+/*
+ *  Appends the record in rec to the sector being filled, which must have
+ *  room for it, and returns its address.
+ */
+static uint32_t
+append(uint16_t len)
+{
+    uint32_t addr;
+
+    addr = SECTOR_ADDR(head) + headOff;
+    NVMem_storeData(addr, REC_HDR_SIZE + len, rec);
+    headOff += REC_SIZE(len);
+    stats.bytesAppended += REC_SIZE(len);
+    return addr;
+}
+
+/*
+ *  Copies the current records of the oldest sector to the sector being
+ *  filled and erases it.
+ */
+static bool
+collect(void)
+{
+    Entry *entry;
+
+    for (entry = entries; entry < &entries[NVMEM_LOG_MAX_IDS]; ++entry)
+    {
+        if (entry->valid && IN_SECTOR(entry->addr, tail))
+        {
+            if (!hasRoom(entry->len))
+            {
+                return false;
+            }
+            NVMem_readData(entry->addr, REC_HDR_SIZE + entry->len, rec);
+            entry->addr = append(entry->len);
+            stats.bytesCopied += REC_SIZE(entry->len);
+        }
+    }
+    eraseSector(tail);
+    tail = next(tail);
+    ++stats.nCollections;
+    return true;
+}
+
+static bool
+advance(void)
+{
+    startSector(next(head));
+    return (next(head) != tail) || collect();
+}
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+NVMemLog_open(uint32_t addr, uint32_t nSectors)
+{
+    uint32_t sector, seq, newest;
+    bool found;
+
+    isOpen = false;
+    if ((nSectors < 2) || (nSectors > NVMEM_LOG_MAX_SECTORS) ||
+        ((addr % NVMEM_SECTOR_SIZE) != 0))
+    {
+        return false;
+    }
+    base = addr;
+    ringSize = nSectors;
+    nextSeq = nextSectorSeq = 0;
+    memset(entries, 0, sizeof(entries));
+    memset(erased, NVMEM_LOG_ERASED_VALUE, sizeof(erased));
+
+    for (sector = 0, newest = 0, found = false; sector < nSectors; ++sector)
+    {
+        used[sector] = readSectorHdr(sector, &seq);
+        if (!used[sector])
+        {
+            eraseSector(sector);
+            continue;
+        }
+        if (!found || (seq >= nextSectorSeq))
+        {
+            newest = sector;
+            nextSectorSeq = seq + 1;
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        tail = 0;
+        startSector(0);
+    }
+    else
+    {
+        head = newest;
+        for (tail = next(head); !used[tail]; tail = next(tail))
+        {
+        }
+        for (sector = tail; sector != head; sector = next(sector))
+        {
+            scanSector(sector);
+        }
+        headOff = scanSector(head);
+        if ((next(head) == tail) && !collect())
+        {
+            return false;
+        }
+    }
+    isOpen = true;
+    return true;
+}
+
+bool
+NVMemLog_write(uint16_t id, const void *data, uint16_t len)
+{
+    uint32_t crc;
+
+    if (!isOpen || (id >= NVMEM_LOG_MAX_IDS) || (len > NVMEM_LOG_MAX_LEN))
+    {
+        return false;
+    }
+    if (!hasRoom(len) && (!advance() || !hasRoom(len)))
+    {
+        return false;
+    }
+    memcpy(&rec[4], &nextSeq, 4);
+    memcpy(&rec[8], &id, 2);
+    memcpy(&rec[10], &len, 2);
+    memcpy(&rec[REC_HDR_SIZE], data, len);
+    crc = Crc32_calc(&rec[4], REC_HDR_SIZE - 4 + len, 0xffffffff);
+    memcpy(&rec[0], &crc, 4);
+    indexRecord(id, nextSeq, append(len), len);
+    ++stats.nWrites;
+    stats.bytesWritten += len;
+    return true;
+}
+
+bool
+NVMemLog_read(uint16_t id, void *data, uint16_t maxLen, uint16_t *len)
+{
+    Entry *entry;
+
+    if (!isOpen || (id >= NVMEM_LOG_MAX_IDS))
+    {
+        return false;
+    }
+    entry = &entries[id];
+    if (!entry->valid || (entry->len > maxLen))
+    {
+        return false;
+    }
+    NVMem_readData(entry->addr + REC_HDR_SIZE, entry->len, data);
+    *len = entry->len;
+    return true;
+}
+
+void
+NVMemLog_getStats(NVMemLogStats *result)
+{
+    *result = stats;
+}
+
+void
+NVMemLog_resetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,193 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_mmap.c
+ *  \brief  Implements the POSIX file-backed NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The image is mapped MAP_SHARED, so stores reach the page cache at once 
+ *  and other processes mapping the same file see them. msync() only 
+ *  bounds when they reach the disk. The dirty range of the deferred 
+ *  policy is kept as [dirtyFrom, dirtyTo), empty when both are equal.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "NVMem_mmap.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint8_t *image;
+static uint32_t imageSize;
+static int fd = -1;
+static NVMemSync policy;
+static uint32_t dirtyFrom, dirtyTo;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static bool
+inImage(uint32_t addr, uint32_t nBytes)
+{
+    return (image != (uint8_t *)0) && (addr <= imageSize) && 
+           (nBytes <= (imageSize - addr));
+}
+
+static bool
+syncRange(uint32_t from, uint32_t to)
+{
+    uint32_t page;
+
+    if (from == to)
+    {
+        return true;
+    }
+    page = (uint32_t)sysconf(_SC_PAGESIZE);
+    from -= from % page;
+    return msync(image + from, to - from, MS_SYNC) == 0;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+NVMemMmap_open(const char *path, uint32_t size, NVMemSync syncPolicy)
+{
+    struct stat st;
+    void *map;
+
+    NVMemMmap_close();
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if ((fstat(fd, &st) != 0) || 
+        ((st.st_size < size) && (ftruncate(fd, size) != 0)))
+    {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    image = map;
+    imageSize = size;
+    policy = syncPolicy;
+    dirtyFrom = dirtyTo = 0;
+    if (st.st_size < size)
+    {
+        memset(image + st.st_size, NVMEM_ERASED_VALUE, size - st.st_size);
+    }
+    return true;
+}
+
+bool
+NVMemMmap_sync(void)
+{
+    bool result;
+
+    if (image == (uint8_t *)0)
+    {
+        return false;
+    }
+    result = syncRange(dirtyFrom, dirtyTo);
+    dirtyFrom = dirtyTo = 0;
+    return result;
+}
+
+void
+NVMemMmap_close(void)
+{
+    if (image != (uint8_t *)0)
+    {
+        NVMemMmap_sync();
+        munmap(image, imageSize);
+        image = (uint8_t *)0;
+        imageSize = 0;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void
+NVMEM_DEV_READ(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    if (inImage(from, nBytes))
+    {
+        memcpy(to, image + from, nBytes);
+    }
+    else
+    {
+        memset(to, NVMEM_ERASED_VALUE, nBytes);
+    }
+}
+
+#if NVMEM_MAP_BY_DEV == 1
+const void *
+NVMem_map(uint32_t addr, uint32_t nBytes)
+{
+    return inImage(addr, nBytes) ? (const void *)(image + addr) : 
+                                   (const void *)0;
+}
+#endif
+
+void
+NVMEM_DEV_STORE(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    if (!inImage(to, nBytes) || (nBytes == 0))
+    {
+        return;
+    }
+    memcpy(image + to, from, nBytes);
+    switch (policy)
+    {
+        case NVMEM_SYNC_IMMEDIATE:
+            syncRange(0, imageSize);
+            break;
+        case NVMEM_SYNC_RANGED:
+            syncRange(to, to + nBytes);
+            break;
+        default:
+            if (dirtyFrom == dirtyTo)
+            {
+                dirtyFrom = to;
+                dirtyTo = to + nBytes;
+            }
+            else
+            {
+                dirtyFrom = (to < dirtyFrom) ? to : dirtyFrom;
+                dirtyTo = ((to + nBytes) > dirtyTo) ? to + nBytes : dirtyTo;
+            }
+            break;
+    }
+}
+
+/* ------------------------------ End of file ------------------------------ */
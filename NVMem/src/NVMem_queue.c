@@ -0,0 +1,287 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_queue.c
+ *  \brief  Implements the asynchronous store queue of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is a bounded multi-producer single-consumer ring. Every entry has
+ *  a sequence number which tells whether it is free for the producer
+ *  which claims position 'pos' (seq == pos), ready to be drained
+ *  (seq == pos + 1) or still in use by the previous lap. A producer
+ *  claims a position by moving the tail with a CAS, fills the entry and
+ *  then publishes it, so the consumer drains the entries in the order
+ *  their positions were claimed. The entry is released before its store
+ *  is done, so a store being written does not take a place of the queue.
+ *
+ *  The worker thread sleeps on a semaphore, posted once per entry, as
+ *  sem_post() can be called from signal handlers. Only the consumer side
+ *  takes locks: 'lock' to wait for the stores to be done, and 'ioLock' so
+ *  that the NVMem_flush() of NVMem_sync() does not run while the worker
+ *  is storing later entries, e.g. into the write-back buffer of
+ *  NVMEM_CACHE.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include "NVMem_queue.h"
+
+#if NVMEM_QUEUE_THREAD == 1
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#endif
+
+/* ----------------------------- Local macros ------------------------------ */
+#define QUEUE_MASK              (NVMEM_QUEUE_SIZE - 1)
+#define LOAD_RLX(p)             __atomic_load_n((p), __ATOMIC_RELAXED)
+#define LOAD_ACQ(p)             __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_REL(p, v)         __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define CLAIM(p, expected)      __atomic_compare_exchange_n((p), (expected), \
+                                    *(expected) + 1, false, \
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define BEFORE(a, b)            ((int32_t)((a) - (b)) < 0)
+
+#if (NVMEM_QUEUE_SIZE & QUEUE_MASK) != 0
+#error "NVMEM_QUEUE_SIZE must be a power of two"
+#endif
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Entry Entry;
+struct Entry
+{
+    uint32_t seq;
+    uint32_t to;
+    uint32_t nBytes;
+    const uint8_t *from;
+    NVMemStoreDone done;
+    void *ctx;
+};
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static Entry entries[NVMEM_QUEUE_SIZE];
+static uint32_t tail;           /* next position to claim */
+static uint32_t head;           /* next position to drain */
+static uint32_t nDone;
+static bool opened;
+
+#if NVMEM_QUEUE_THREAD == 1
+static pthread_t thread;
+static sem_t ready;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t ioLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t doneCond = PTHREAD_COND_INITIALIZER;
+static bool stop;
+#endif
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static bool
+take(Entry *entry)
+{
+    Entry *slot;
+
+    slot = &entries[head & QUEUE_MASK];
+    if (LOAD_ACQ(&slot->seq) != (head + 1))
+    {
+        return false;
+    }
+    *entry = *slot;
+    STORE_REL(&slot->seq, head + NVMEM_QUEUE_SIZE);
+    ++head;
+    return true;
+}
+
+static void
+run(const Entry *entry)
+{
+#if NVMEM_QUEUE_THREAD == 1
+    pthread_mutex_lock(&ioLock);
+    NVMem_storeData(entry->to, entry->nBytes, entry->from);
+    pthread_mutex_unlock(&ioLock);
+#else
+    NVMem_storeData(entry->to, entry->nBytes, entry->from);
+#endif
+    if (entry->done != (NVMemStoreDone)0)
+    {
+        entry->done(entry->ctx);
+    }
+#if NVMEM_QUEUE_THREAD == 1
+    pthread_mutex_lock(&lock);
+    ++nDone;
+    pthread_cond_broadcast(&doneCond);
+    pthread_mutex_unlock(&lock);
+#else
+    ++nDone;
+#endif
+}
+
+#if NVMEM_QUEUE_THREAD == 1
+static void *
+worker(void *arg)
+{
+    Entry entry;
+
+    (void)arg;
+    for (;;)
+    {
+        while ((sem_wait(&ready) != 0) && (errno == EINTR))
+        {
+        }
+        if (LOAD_ACQ(&stop))
+        {
+            break;
+        }
+        /* the entry at head was claimed, it is being filled */
+        while (!take(&entry))
+        {
+            sched_yield();
+        }
+        run(&entry);
+    }
+    return NULL;
+}
+#endif
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+NVMemQueue_open(void)
+{
+    uint32_t i;
+
+    NVMemQueue_close();
+    for (i = 0; i < NVMEM_QUEUE_SIZE; ++i)
+    {
+        entries[i].seq = i;
+    }
+    tail = head = nDone = 0;
+#if NVMEM_QUEUE_THREAD == 1
+    stop = false;
+    if (sem_init(&ready, 0, 0) != 0)
+    {
+        return false;
+    }
+    if (pthread_create(&thread, NULL, worker, NULL) != 0)
+    {
+        sem_destroy(&ready);
+        return false;
+    }
+#endif
+    opened = true;
+    return true;
+}
+
+void
+NVMemQueue_close(void)
+{
+    if (!opened)
+    {
+        return;
+    }
+    NVMem_sync();
+#if NVMEM_QUEUE_THREAD == 1
+    STORE_REL(&stop, true);
+    sem_post(&ready);
+    pthread_join(thread, NULL);
+    sem_destroy(&ready);
+#endif
+    opened = false;
+}
+
+#if NVMEM_QUEUE_THREAD == 0
+unsigned int
+NVMemQueue_drain(void)
+{
+    Entry entry;
+    unsigned int n;
+
+    for (n = 0; take(&entry); ++n)
+    {
+        run(&entry);
+    }
+    return n;
+}
+#endif
+
+bool
+NVMem_storeDataAsync(uint32_t to, uint32_t nBytes, const uint8_t *from,
+                     NVMemStoreDone done, void *ctx)
+{
+    Entry *slot;
+    uint32_t pos, seq;
+
+    pos = LOAD_RLX(&tail);
+    for (;;)
+    {
+        slot = &entries[pos & QUEUE_MASK];
+        seq = LOAD_ACQ(&slot->seq);
+        if (seq == pos)
+        {
+            if (CLAIM(&tail, &pos))
+            {
+                break;
+            }
+        }
+        else if (BEFORE(seq, pos))
+        {
+            return false;
+        }
+        else
+        {
+            pos = LOAD_RLX(&tail);
+        }
+    }
+    slot->to = to;
+    slot->nBytes = nBytes;
+    slot->from = from;
+    slot->done = done;
+    slot->ctx = ctx;
+    STORE_REL(&slot->seq, pos + 1);
+#if NVMEM_QUEUE_THREAD == 1
+    sem_post(&ready);
+#endif
+    return true;
+}
+
+void
+NVMem_sync(void)
+{
+    uint32_t ticket;
+
+    ticket = LOAD_ACQ(&tail);
+#if NVMEM_QUEUE_THREAD == 1
+    pthread_mutex_lock(&lock);
+    while (BEFORE(nDone, ticket))
+    {
+        pthread_cond_wait(&doneCond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+    pthread_mutex_lock(&ioLock);
+    NVMem_flush();
+    pthread_mutex_unlock(&ioLock);
+#else
+    while (BEFORE(nDone, ticket))
+    {
+        NVMemQueue_drain();
+    }
+    NVMem_flush();
+#endif
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,315 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_sched.c
+ *  \brief  Implements the request scheduler of the NVMem clients.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  Times are compared by the sign of their difference, so they can wrap
+ *  around.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "NVMem_sched.h"
+#include "NVMem_part.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+#define BEFORE(a, b)            ((int32_t)((a) - (b)) < 0)
+#define MIN(a, b)               (((a) < (b)) ? (a) : (b))
+
+#define CLIENT_CFG(name, cls, budget) \
+    {cls, budget},
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Request Request;
+struct Request
+{
+    uint32_t addr;
+    uint32_t nBytes;
+    uint32_t nDone;
+    uint8_t *buf;
+    bool isStore;
+    bool hasDeadline;
+    uint32_t deadline;
+    uint32_t submitted;
+    uint32_t seq;
+    NVMemSchedDone done;
+    void *ctx;
+};
+
+typedef struct Client Client;
+struct Client
+{
+    NVMemSchedClass cls;
+    uint32_t budget;
+    uint32_t used;              /* bytes in this period */
+    uint32_t head;
+    uint32_t count;
+    Request requests[NVMEM_SCHED_DEPTH];
+    NVMemSchedStats stats;
+};
+
+typedef struct ClientCfg ClientCfg;
+struct ClientCfg
+{
+    NVMemSchedClass cls;
+    uint32_t budget;
+};
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static const ClientCfg clientCfgs[NVMEM_SCHED_NUM_CLIENTS] =
+{
+    NVMEM_SCHED_CLIENTS(CLIENT_CFG)
+};
+static Client clients[NVMEM_SCHED_NUM_CLIENTS];
+static uint32_t periodStart;
+static uint32_t nextSeq;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static bool
+submit(NVMemSchedClient id, uint32_t addr, uint32_t nBytes, uint8_t *buf,
+       bool isStore, uint32_t deadline, NVMemSchedDone done, void *ctx)
+{
+    Client *client;
+    Request *req;
+
+    if ((id >= NVMEM_SCHED_NUM_CLIENTS) ||
+        (clients[id].count == NVMEM_SCHED_DEPTH))
+    {
+        return false;
+    }
+    client = &clients[id];
+    req = &client->requests[(client->head + client->count) %
+                            NVMEM_SCHED_DEPTH];
+    req->addr = addr;
+    req->nBytes = nBytes;
+    req->nDone = 0;
+    req->buf = buf;
+    req->isStore = isStore;
+    req->submitted = NVMemSched_now();
+    req->hasDeadline = (deadline != NVMEM_SCHED_NO_DEADLINE);
+    req->deadline = req->submitted + deadline;
+    req->seq = nextSeq++;
+    req->done = done;
+    req->ctx = ctx;
+
+    ++client->count;
+    client->stats.depth = client->count;
+    if (client->count > client->stats.maxDepth)
+    {
+        client->stats.maxDepth = client->count;
+    }
+    return true;
+}
+
+static bool
+isDue(const Request *req, uint32_t now)
+{
+    return req->hasDeadline &&
+           BEFORE(req->deadline, now + NVMEM_SCHED_SLACK + 1);
+}
+
+static bool
+isOverBudget(const Client *client)
+{
+    return (client->budget != 0) && (client->used >= client->budget);
+}
+
+/*
+ *  Returns true when the head request of client a goes before the one
+ *  of client b.
+ */
+static bool
+goesBefore(const Client *a, const Client *b, uint32_t now)
+{
+    const Request *ra, *rb;
+
+    ra = &a->requests[a->head];
+    rb = &b->requests[b->head];
+    if (isDue(ra, now) != isDue(rb, now))
+    {
+        return isDue(ra, now);
+    }
+    if (!isDue(ra, now) && (isOverBudget(a) != isOverBudget(b)))
+    {
+        return !isOverBudget(a);
+    }
+    if (!isDue(ra, now) && (a->cls != b->cls))
+    {
+        return a->cls < b->cls;
+    }
+    if (ra->hasDeadline != rb->hasDeadline)
+    {
+        return ra->hasDeadline;
+    }
+    if (ra->hasDeadline && (ra->deadline != rb->deadline))
+    {
+        return BEFORE(ra->deadline, rb->deadline);
+    }
+    return BEFORE(ra->seq, rb->seq);
+}
+
+static void
+complete(Client *client, Request *req, uint32_t now)
+{
+    uint32_t latency;
+
+    client->head = (client->head + 1) % NVMEM_SCHED_DEPTH;
+    --client->count;
+    latency = now - req->submitted;
+    client->stats.depth = client->count;
+    ++client->stats.nDone;
+    client->stats.bytes += req->nBytes;
+    client->stats.totalLatency += latency;
+    if (latency > client->stats.maxLatency)
+    {
+        client->stats.maxLatency = latency;
+    }
+    if (req->hasDeadline && BEFORE(req->deadline, now))
+    {
+        ++client->stats.nMissed;
+    }
+    if (req->done != (NVMemSchedDone)0)
+    {
+        req->done(req->ctx);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+NVMemSched_open(void)
+{
+    uint32_t id;
+
+    memset(clients, 0, sizeof(clients));
+    for (id = 0; id < NVMEM_SCHED_NUM_CLIENTS; ++id)
+    {
+        clients[id].cls = clientCfgs[id].cls;
+        clients[id].budget = clientCfgs[id].budget;
+    }
+    periodStart = NVMemSched_now();
+    nextSeq = 0;
+}
+
+bool
+NVMemSched_read(NVMemSchedClient client, uint32_t from, uint32_t nBytes,
+                uint8_t *to, uint32_t deadline, NVMemSchedDone done,
+                void *ctx)
+{
+    return submit(client, from, nBytes, to, false, deadline, done, ctx);
+}
+
+bool
+NVMemSched_store(NVMemSchedClient client, uint32_t to, uint32_t nBytes,
+                 const uint8_t *from, uint32_t deadline,
+                 NVMemSchedDone done, void *ctx)
+{
+    return submit(client, to, nBytes, (uint8_t *)from, true, deadline,
+                  done, ctx);
+}
+
+bool
+NVMemSched_dispatch(void)
+{
+    Client *client, *next;
+    Request *req;
+    uint32_t now, addr, chunk;
+
+    now = NVMemSched_now();
+    if ((now - periodStart) >= NVMEM_SCHED_PERIOD)
+    {
+        periodStart = now;
+        for (client = clients; client < &clients[NVMEM_SCHED_NUM_CLIENTS];
+             ++client)
+        {
+            client->used = 0;
+        }
+    }
+
+    for (client = clients, next = (Client *)0;
+         client < &clients[NVMEM_SCHED_NUM_CLIENTS]; ++client)
+    {
+        if ((client->count != 0) &&
+            ((next == (Client *)0) || goesBefore(client, next, now)))
+        {
+            next = client;
+        }
+    }
+    if (next == (Client *)0)
+    {
+        return false;
+    }
+
+    req = &next->requests[next->head];
+    addr = req->addr + req->nDone;
+    if (req->isStore)
+    {
+        chunk = MIN(req->nBytes - req->nDone,
+                    NVMEM_SECTOR_SIZE - (addr % NVMEM_SECTOR_SIZE));
+        NVMem_storeData(addr, chunk, req->buf + req->nDone);
+    }
+    else
+    {
+        chunk = MIN(req->nBytes - req->nDone, NVMEM_SCHED_CHUNK);
+        NVMem_readData(addr, chunk, req->buf + req->nDone);
+    }
+    req->nDone += chunk;
+    next->used += chunk;
+    if (req->nDone == req->nBytes)
+    {
+        complete(next, req, NVMemSched_now());
+    }
+    return true;
+}
+
+void
+NVMemSched_setClass(NVMemSchedClient client, NVMemSchedClass cls,
+                    uint32_t budget)
+{
+    if (client < NVMEM_SCHED_NUM_CLIENTS)
+    {
+        clients[client].cls = cls;
+        clients[client].budget = budget;
+    }
+}
+
+void
+NVMemSched_getStats(NVMemSchedClient client, NVMemSchedStats *result)
+{
+    if (client < NVMEM_SCHED_NUM_CLIENTS)
+    {
+        *result = clients[client].stats;
+    }
+}
+
+void
+NVMemSched_resetStats(void)
+{
+    uint32_t id;
+
+    for (id = 0; id < NVMEM_SCHED_NUM_CLIENTS; ++id)
+    {
+        memset(&clients[id].stats, 0, sizeof(clients[id].stats));
+        clients[id].stats.depth = clients[id].count;
+    }
+}
+
+/* ------------------------------ End of file ------------------------------ */
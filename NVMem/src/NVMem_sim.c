@@ -0,0 +1,274 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_sim.c
+ *  \brief  Implements the simulated flash NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  A page is programmed from a page-sized image in which the bytes out of
+ *  the store hold their current value, so programming them does not
+ *  change the cells.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdlib.h>
+#include <string.h>
+#include "NVMem_sim.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+#define MIN(a, b)               (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)               (((a) > (b)) ? (a) : (b))
+
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemSimCfg cfg;
+static NVMemSimStats stats;
+static uint64_t now;
+static uint8_t *flash;
+static uint8_t *sectorBuf;
+static uint32_t *eraseCounts;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static bool
+inPart(uint32_t addr, uint32_t nBytes)
+{
+    return (flash != (uint8_t *)0) && (addr <= cfg.size) &&
+           (nBytes <= (cfg.size - addr));
+}
+
+static bool
+isErased(const uint8_t *data, uint32_t nBytes)
+{
+    for (; nBytes != 0; --nBytes, ++data)
+    {
+        if (*data != NVMEM_SIM_ERASED_VALUE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+needsErase(const uint8_t *cells, const uint8_t *data, uint32_t nBytes)
+{
+    for (; nBytes != 0; --nBytes, ++cells, ++data)
+    {
+        if ((~*cells & *data) != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void
+eraseSector(uint32_t sector)
+{
+    memset(flash + (sector * cfg.sectorSize), NVMEM_SIM_ERASED_VALUE,
+           cfg.sectorSize);
+    ++eraseCounts[sector];
+    stats.maxEraseCount = MAX(stats.maxEraseCount, eraseCounts[sector]);
+    ++stats.nErases;
+    now += cfg.eraseNs;
+}
+
+static void
+programPage(uint32_t addr, const uint8_t *data)
+{
+    uint8_t *cells;
+    uint32_t i;
+
+    cells = flash + addr;
+    if (needsErase(cells, data, cfg.pageSize))
+    {
+        ++stats.nViolations;
+    }
+    for (i = 0; i < cfg.pageSize; ++i)
+    {
+        cells[i] &= data[i];
+    }
+    ++stats.nPrograms;
+    stats.bytesProgrammed += cfg.pageSize;
+    now += cfg.programNs;
+}
+
+/*
+ *  Stores [from, to) of a single sector, erasing it when needed and
+ *  allowed.
+ */
+static void
+storeSector(uint32_t sector, uint32_t from, uint32_t to, const uint8_t *data)
+{
+    uint32_t begin, page;
+    uint8_t *image;
+
+    begin = sector * cfg.sectorSize;
+    image = sectorBuf;
+    if (!cfg.strict && needsErase(flash + from, data, to - from))
+    {
+        memcpy(image, flash + begin, cfg.sectorSize);
+        memcpy(image + (from - begin), data, to - from);
+        eraseSector(sector);
+        for (page = begin; page < (begin + cfg.sectorSize);
+             page += cfg.pageSize)
+        {
+            if (!isErased(image + (page - begin), cfg.pageSize))
+            {
+                programPage(page, image + (page - begin));
+            }
+        }
+        return;
+    }
+
+    memcpy(image, flash + begin, cfg.sectorSize);
+    memcpy(image + (from - begin), data, to - from);
+    for (page = from - (from % cfg.pageSize); page < to;
+         page += cfg.pageSize)
+    {
+        programPage(page, image + (page - begin));
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+NVMemSim_open(const NVMemSimCfg *config)
+{
+    NVMemSim_close();
+    if ((config->pageSize == 0) || (config->sectorSize == 0) ||
+        (config->size == 0) ||
+        ((config->sectorSize % config->pageSize) != 0) ||
+        ((config->size % config->sectorSize) != 0))
+    {
+        return false;
+    }
+
+    cfg = *config;
+    flash = malloc(cfg.size);
+    sectorBuf = malloc(cfg.sectorSize);
+    eraseCounts = calloc(cfg.size / cfg.sectorSize, sizeof(uint32_t));
+    if ((flash == (uint8_t *)0) || (sectorBuf == (uint8_t *)0) ||
+        (eraseCounts == (uint32_t *)0))
+    {
+        NVMemSim_close();
+        return false;
+    }
+    memset(flash, NVMEM_SIM_ERASED_VALUE, cfg.size);
+    memset(&stats, 0, sizeof(stats));
+    now = 0;
+    return true;
+}
+
+void
+NVMemSim_close(void)
+{
+    free(flash);
+    free(sectorBuf);
+    free(eraseCounts);
+    flash = sectorBuf = (uint8_t *)0;
+    eraseCounts = (uint32_t *)0;
+}
+
+bool
+NVMemSim_erase(uint32_t addr)
+{
+    if (!inPart(addr, 1))
+    {
+        return false;
+    }
+    eraseSector(addr / cfg.sectorSize);
+    return true;
+}
+
+uint64_t
+NVMemSim_now(void)
+{
+    return now;
+}
+
+uint32_t
+NVMemSim_eraseCount(uint32_t sector)
+{
+    if ((flash == (uint8_t *)0) || (sector >= (cfg.size / cfg.sectorSize)))
+    {
+        return 0;
+    }
+    return eraseCounts[sector];
+}
+
+void
+NVMemSim_getStats(NVMemSimStats *result)
+{
+    *result = stats;
+}
+
+/**
+ *  It does not reset the erase counts, so maxEraseCount is kept.
+ */
+void
+NVMemSim_resetStats(void)
+{
+    uint32_t maxEraseCount;
+
+    maxEraseCount = stats.maxEraseCount;
+    memset(&stats, 0, sizeof(stats));
+    stats.maxEraseCount = maxEraseCount;
+}
+
+void
+NVMEM_DEV_READ(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    uint32_t page;
+
+    if (!inPart(from, nBytes))
+    {
+        memset(to, NVMEM_SIM_ERASED_VALUE, nBytes);
+        return;
+    }
+    memcpy(to, flash + from, nBytes);
+    stats.bytesRead += nBytes;
+    for (page = from - (from % cfg.pageSize); page < (from + nBytes);
+         page += cfg.pageSize)
+    {
+        ++stats.nReads;
+        now += cfg.readNs;
+    }
+}
+
+void
+NVMEM_DEV_STORE(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    uint32_t sector, begin, end, chunkEnd;
+
+    if (!inPart(to, nBytes) || (nBytes == 0))
+    {
+        return;
+    }
+    stats.bytesStored += nBytes;
+    end = to + nBytes;
+    for (begin = to; begin < end; from += chunkEnd - begin, begin = chunkEnd)
+    {
+        sector = begin / cfg.sectorSize;
+        chunkEnd = MIN(end, (sector + 1) * cfg.sectorSize);
+        storeSector(sector, begin, chunkEnd, from);
+    }
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,405 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   NVMem_wear.c
+ *  \brief  Implements the wear-leveling layer of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The map records are appended to a map sector, in slots of SLOT_SIZE
+ *  bytes, and the one with the greatest sequence number and a valid CRC
+ *  is the current one. When a map sector is full, the other one is
+ *  erased and the records go on there, so the current record is never
+ *  erased before the next one is written.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "NVMem_wear.h"
+
+#if defined(NVMEM_WEAR)
+
+/* ----------------------------- Local macros ------------------------------ */
+#define MAP_ADDR(m, slot) \
+    (NVMEM_WEAR_BASE + ((m) * NVMEM_SECTOR_SIZE) + ((slot) * SLOT_SIZE))
+#define SECTOR_ADDR(s) \
+    (NVMEM_WEAR_BASE + (((s) + 2) * NVMEM_SECTOR_SIZE))
+#define MIN(a, b)               (((a) < (b)) ? (a) : (b))
+
+/* ------------------------------- Constants ------------------------------- */
+#define SLOT_SIZE               (((sizeof(Map) + 15) / 16) * 16)
+#define NUM_SLOTS               (NVMEM_SECTOR_SIZE / SLOT_SIZE)
+#define CHECK_CHUNK             64
+
+/* ---------------------------- Local data types --------------------------- */
+typedef struct Map Map;
+struct Map
+{
+    uint32_t crc;
+    uint32_t seq;
+    uint32_t counts[NVMEM_WEAR_SECTORS];
+    uint8_t sectors[NVMEM_WEAR_BLOCKS];     /* of every block */
+};
+
+_Static_assert(NVMEM_WEAR_BLOCKS < NVMEM_WEAR_SECTORS,
+               "NVMem wear-leveling needs more sectors than blocks");
+_Static_assert(NVMEM_WEAR_SECTORS <= 255,
+               "NVMem wear-leveling sectors do not fit in a byte");
+_Static_assert(NUM_SLOTS >= 2, "NVMem wear-leveling map is too large");
+
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static Map map;
+static Map loaded;
+static uint32_t mapSector;
+static uint32_t mapSlot;
+static bool isOpen;
+static uint8_t page[NVMEM_PAGE_SIZE];
+static uint8_t chunk[CHECK_CHUNK];
+static uint8_t erased[NVMEM_SECTOR_SIZE];
+static NVMemWearStats stats;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static bool
+isErasedAt(uint32_t addr, uint32_t nBytes)
+{
+    uint32_t n;
+
+    for (; nBytes != 0; nBytes -= n, addr += n)
+    {
+        n = MIN(nBytes, CHECK_CHUNK);
+        NVMemDev_readData(addr, n, chunk);
+        if (memcmp(chunk, erased, n) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+eraseAt(uint32_t addr)
+{
+    if (isErasedAt(addr, NVMEM_SECTOR_SIZE))
+    {
+        return false;
+    }
+    NVMemDev_storeData(addr, NVMEM_SECTOR_SIZE, erased);
+    return true;
+}
+
+/*
+ *  Returns true when storing nBytes at addr needs to set a bit.
+ */
+static bool
+needsErase(uint32_t addr, uint32_t nBytes, const uint8_t *from)
+{
+    uint32_t n, i;
+
+    for (; nBytes != 0; nBytes -= n, addr += n, from += n)
+    {
+        n = MIN(nBytes, CHECK_CHUNK);
+        NVMemDev_readData(addr, n, chunk);
+        for (i = 0; i < n; ++i)
+        {
+            if ((~chunk[i] & from[i]) != 0)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool
+isFree(uint32_t sector)
+{
+    uint32_t block;
+
+    for (block = 0; block < NVMEM_WEAR_BLOCKS; ++block)
+    {
+        if (map.sectors[block] == sector)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+loadMap(void)
+{
+    uint32_t m, slot;
+    bool found;
+
+    for (m = 0, found = false; m < 2; ++m)
+    {
+        for (slot = 0; slot < NUM_SLOTS; ++slot)
+        {
+            NVMemDev_readData(MAP_ADDR(m, slot), sizeof(loaded),
+                              (uint8_t *)&loaded);
+            if (memcmp(&loaded, erased, 8) == 0)
+            {
+                break;
+            }
+            if ((loaded.crc == Crc32_calc((const uint8_t *)&loaded.seq,
+                                          sizeof(loaded) - 4,
+                                          0xffffffff)) &&
+                (!found || (loaded.seq > map.seq)))
+            {
+                map = loaded;
+                mapSector = m;
+                mapSlot = slot + 1;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+static void
+storeMap(void)
+{
+    ++map.seq;
+    map.crc = Crc32_calc((const uint8_t *)&map.seq, sizeof(map) - 4,
+                         0xffffffff);
+    for (;; ++mapSlot)
+    {
+        if (mapSlot == NUM_SLOTS)
+        {
+            mapSector ^= 1;
+            mapSlot = 0;
+            if (eraseAt(MAP_ADDR(mapSector, 0)))
+            {
+                ++stats.nMapErases;
+            }
+        }
+        if (isErasedAt(MAP_ADDR(mapSector, mapSlot), SLOT_SIZE))
+        {
+            break;
+        }
+    }
+    NVMemDev_storeData(MAP_ADDR(mapSector, mapSlot), sizeof(map),
+                       (const uint8_t *)&map);
+    ++mapSlot;
+    ++stats.nMapWrites;
+}
+
+/*
+ *  Moves a block to the free sector 'to', merging its former contents
+ *  with nBytes at offset 'off', persists the map and erases the sector
+ *  left. The erase is counted in the map persisted before it, unless
+ *  the sector left is already erased.
+ */
+static void
+moveBlock(uint32_t block, uint32_t to, uint32_t off, uint32_t nBytes,
+          const uint8_t *from)
+{
+    uint32_t left, pos, begin, end;
+    bool isDirty;
+
+    left = map.sectors[block];
+    for (pos = 0; pos < NVMEM_SECTOR_SIZE; pos += NVMEM_PAGE_SIZE)
+    {
+        NVMemDev_readData(SECTOR_ADDR(left) + pos, NVMEM_PAGE_SIZE, page);
+        begin = (off > pos) ? off : pos;
+        end = MIN(off + nBytes, pos + NVMEM_PAGE_SIZE);
+        if (begin < end)
+        {
+            memcpy(&page[begin - pos], from + (begin - off), end - begin);
+        }
+        if (memcmp(page, erased, NVMEM_PAGE_SIZE) != 0)
+        {
+            NVMemDev_storeData(SECTOR_ADDR(to) + pos, NVMEM_PAGE_SIZE, page);
+        }
+    }
+    map.sectors[block] = (uint8_t)to;
+    isDirty = !isErasedAt(SECTOR_ADDR(left), NVMEM_SECTOR_SIZE);
+    if (isDirty)
+    {
+        ++map.counts[left];
+    }
+    storeMap();
+    if (isDirty)
+    {
+        NVMemDev_storeData(SECTOR_ADDR(left), NVMEM_SECTOR_SIZE, erased);
+    }
+}
+
+/*
+ *  Finds the free sector with the lowest erase count, when 'coldest' is
+ *  set, or with the highest one.
+ */
+static uint32_t
+freeSector(bool coldest)
+{
+    uint32_t sector, found;
+
+    for (sector = 0, found = NVMEM_WEAR_SECTORS;
+         sector < NVMEM_WEAR_SECTORS; ++sector)
+    {
+        if (isFree(sector) &&
+            ((found == NVMEM_WEAR_SECTORS) ||
+             (coldest && (map.counts[sector] < map.counts[found])) ||
+             (!coldest && (map.counts[sector] > map.counts[found]))))
+        {
+            found = sector;
+        }
+    }
+    return found;
+}
+
+static void
+level(void)
+{
+    uint32_t block, cold, worn;
+
+    for (block = 1, cold = 0; block < NVMEM_WEAR_BLOCKS; ++block)
+    {
+        if (map.counts[map.sectors[block]] <
+            map.counts[map.sectors[cold]])
+        {
+            cold = block;
+        }
+    }
+    worn = freeSector(false);
+    if (map.counts[worn] >
+        (map.counts[map.sectors[cold]] + NVMEM_WEAR_DELTA))
+    {
+        moveBlock(cold, worn, 0, 0, (const uint8_t *)0);
+        ++stats.nMigrations;
+    }
+}
+
+static void
+storeBlock(uint32_t block, uint32_t off, uint32_t nBytes,
+           const uint8_t *from)
+{
+    uint32_t addr;
+
+    addr = SECTOR_ADDR(map.sectors[block]) + off;
+    if (!needsErase(addr, nBytes, from))
+    {
+        NVMemDev_storeData(addr, nBytes, from);
+        return;
+    }
+    moveBlock(block, freeSector(true), off, nBytes, from);
+    ++stats.nRelocations;
+    level();
+}
+
+/* ---------------------------- Global functions --------------------------- */
+bool
+NVMemWear_open(void)
+{
+    uint32_t sector;
+    bool isErased;
+
+    memset(erased, NVMEM_WEAR_ERASED_VALUE, sizeof(erased));
+    if (!loadMap())
+    {
+        memset(&map, 0, sizeof(map));
+        for (sector = 0; sector < NVMEM_WEAR_BLOCKS; ++sector)
+        {
+            map.sectors[sector] = (uint8_t)sector;
+        }
+        mapSector = 1;
+        mapSlot = NUM_SLOTS;
+        storeMap();
+    }
+    for (sector = 0, isErased = false; sector < NVMEM_WEAR_SECTORS;
+         ++sector)
+    {
+        if (isFree(sector) && eraseAt(SECTOR_ADDR(sector)))
+        {
+            ++map.counts[sector];
+            isErased = true;
+        }
+    }
+    if (isErased)
+    {
+        storeMap();
+    }
+    isOpen = true;
+    return true;
+}
+
+uint32_t
+NVMemWear_eraseCount(uint32_t sector)
+{
+    return (sector < NVMEM_WEAR_SECTORS) ? map.counts[sector] : 0;
+}
+
+void
+NVMemWear_getStats(NVMemWearStats *result)
+{
+    *result = stats;
+}
+
+void
+NVMemWear_resetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void
+NVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    uint32_t block, off, n;
+
+    if (!isOpen)
+    {
+        NVMemWear_open();
+    }
+    for (; nBytes != 0; nBytes -= n, from += n, to += n)
+    {
+        block = from / NVMEM_SECTOR_SIZE;
+        off = from % NVMEM_SECTOR_SIZE;
+        n = MIN(nBytes, NVMEM_SECTOR_SIZE - off);
+        if (block >= NVMEM_WEAR_BLOCKS)
+        {
+            memset(to, NVMEM_WEAR_ERASED_VALUE, n);
+            continue;
+        }
+        NVMemDev_readData(SECTOR_ADDR(map.sectors[block]) + off, n, to);
+    }
+}
+
+void
+NVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    uint32_t block, off, n;
+
+    if (!isOpen)
+    {
+        NVMemWear_open();
+    }
+    for (; nBytes != 0; nBytes -= n, to += n, from += n)
+    {
+        block = to / NVMEM_SECTOR_SIZE;
+        off = to % NVMEM_SECTOR_SIZE;
+        n = MIN(nBytes, NVMEM_SECTOR_SIZE - off);
+        if (block < NVMEM_WEAR_BLOCKS)
+        {
+            storeBlock(block, off, n, from);
+        }
+    }
+}
+
+#endif
+
+/* ------------------------------ End of file ------------------------------ */
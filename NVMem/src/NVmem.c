@@ -14,7 +14,7 @@
  */
 
 /**
- *  \file   module.c
+ *  \file   NVmem.c
  *  \brief  Implements the specifications.
  */
 
@@ -24,17 +24,126 @@
 
 /* -------------------------------- Authors -------------------------------- */
 /*
- *  RiGr  Rick Grimes  rick.grimes@twd.com
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  When the non-volatile memory is memory-mapped at NVMEM_BASE_ADDR, as 
+ *  the internal flash of a MCU, NVMem_readDataCrc() copies and calculates 
+ *  the CRC in a single pass by means of Crc32_copyCalc(). Otherwise, it 
+ *  reads by means of NVMem_readData() in chunks of NVMEM_CRC_CHUNK bytes 
+ *  and calculates the CRC of each chunk right after reading it, while it 
+ *  is still in the cache.
+ */
+
 /* ----------------------------- Include files ----------------------------- */
+#include "NVMem.h"
+
 /* ----------------------------- Local macros ------------------------------ */
+#ifndef NVMEM_CRC_CHUNK
+#define NVMEM_CRC_CHUNK         256
+#endif
+
 /* ------------------------------- Constants ------------------------------- */
 /* ---------------------------- Local data types --------------------------- */
 /* ---------------------------- Global variables --------------------------- */
 /* ---------------------------- Local variables ---------------------------- */
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+#if NVMEM_VECTORED_BY_DEV == 0
+/*
+ *  Takes the first segment of the array, merged with the following ones 
+ *  which are contiguous with it.
+ */
+static NVMemSeg
+takeMerged(const NVMemSeg **segs, uint32_t *nSegs)
+{
+    NVMemSeg seg;
+
+    seg = **segs;
+    for (++*segs, --*nSegs; 
+         (*nSegs != 0) && ((*segs)->addr == (seg.addr + seg.nBytes)) && 
+         ((*segs)->buf == (seg.buf + seg.nBytes)); 
+         ++*segs, --*nSegs)
+    {
+        seg.nBytes += (*segs)->nBytes;
+    }
+    return seg;
+}
+#endif
+
 /* ---------------------------- Global functions --------------------------- */
+void
+NVMem_readDataCrc(uint32_t from, uint32_t nBytes, uint8_t *to, Crc32 *crc)
+{
+#if defined(NVMEM_BASE_ADDR) && !defined(NVMEM_CACHE) && \
+    !defined(NVMEM_WEAR)
+    *crc = Crc32_copyCalc(to, 
+                          (const uint8_t *)(uintptr_t)(NVMEM_BASE_ADDR + 
+                                                       from), 
+                          nBytes, 0xffffffff);
+#else
+    Crc32Ctx ctx;
+    uint32_t chunk;
+
+    Crc32_begin(&ctx, 0xffffffff);
+    for (; nBytes != 0; nBytes -= chunk, from += chunk, to += chunk)
+    {
+        chunk = (nBytes < NVMEM_CRC_CHUNK) ? nBytes : NVMEM_CRC_CHUNK;
+        NVMem_readData(from, chunk, to);
+        Crc32_update(&ctx, to, chunk);
+    }
+    *crc = Crc32_final(&ctx);
+#endif
+}
+
+#if NVMEM_VECTORED_BY_DEV == 0
+void
+NVMem_readv(const NVMemSeg *segs, uint32_t nSegs)
+{
+    NVMemSeg seg;
+
+    while (nSegs != 0)
+    {
+        seg = takeMerged(&segs, &nSegs);
+        NVMem_readData(seg.addr, seg.nBytes, seg.buf);
+    }
+}
+
+void
+NVMem_writev(const NVMemSeg *segs, uint32_t nSegs)
+{
+    NVMemSeg seg;
+
+    while (nSegs != 0)
+    {
+        seg = takeMerged(&segs, &nSegs);
+        NVMem_storeData(seg.addr, seg.nBytes, seg.buf);
+    }
+}
+#endif
+
+#if NVMEM_MAP_BY_DEV == 0
+const void *
+NVMem_map(uint32_t addr, uint32_t nBytes)
+{
+    (void)nBytes;
+#if defined(NVMEM_BASE_ADDR) && !defined(NVMEM_CACHE) && \
+    !defined(NVMEM_WEAR)
+    return (const void *)(uintptr_t)(NVMEM_BASE_ADDR + addr);
+#else
+    (void)addr;
+    return (const void *)0;
+#endif
+}
+#endif
+
+#if !defined(NVMEM_CACHE)
+void
+NVMem_flush(void)
+{
+}
+#endif
+
 /* ------------------------------ End of file ------------------------------ */
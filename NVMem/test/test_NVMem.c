@@ -14,7 +14,7 @@
  */
 
 /**
- *  \file   test_module.c
+ *  \file   test_NVMem.c
  *  \brief  Unit test for this module.
  */
 
@@ -24,36 +24,127 @@
 
 /* -------------------------------- Authors -------------------------------- */
 /*
- *  RiGr  Rick Grimes  rick.grimes@twd.com
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
  */
 
 /* --------------------------------- Notes --------------------------------- */
+/*
+ *  NVMem_readData() and NVMem_storeData() are provided by the platform,
+ *  so they are implemented here on top of a RAM image.
+ */
+
 /* ----------------------------- Include files ----------------------------- */
+#include <string.h>
 #include "unity.h"
-#include "module.h"
+#include "NVMem.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
 
 /* ----------------------------- Local macros ------------------------------ */
 /* ------------------------------- Constants ------------------------------- */
 /* ---------------------------- Local data types --------------------------- */
 /* ---------------------------- Global variables --------------------------- */
 /* ---------------------------- Local variables ---------------------------- */
+static uint8_t nvImage[1024];
+static uint8_t ram[1024];
+static int nReads;
+static int nStores;
+
 /* ----------------------- Local function prototypes ----------------------- */
 /* ---------------------------- Local functions ---------------------------- */
+static void
+fillImage(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(nvImage); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        nvImage[i] = (uint8_t)(seed >> 16);
+    }
+}
+
 /* ---------------------------- Global functions --------------------------- */
-void 
+void
+NVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    TEST_ASSERT_TRUE((from + nBytes) <= sizeof(nvImage));
+    memcpy(to, &nvImage[from], nBytes);
+    ++nReads;
+}
+
+void
+NVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    TEST_ASSERT_TRUE((to + nBytes) <= sizeof(nvImage));
+    memcpy(&nvImage[to], from, nBytes);
+    ++nStores;
+}
+
+void
 setUp(void)
 {
+    Crc32_init();
+    fillImage(0x5eed);
+    memset(ram, 0, sizeof(ram));
+    nReads = nStores = 0;
 }
 
-void 
+void
 tearDown(void)
 {
 }
 
 void
-test_Init(void)
+test_ReadDataAndCalculateCrc(void)
+{
+    static const uint32_t lens[] = {1, 16, 255, 256, 257, 700};
+    Crc32 crc;
+    size_t i;
+
+    for (i = 0; i < (sizeof(lens) / sizeof(lens[0])); ++i)
+    {
+        NVMem_readDataCrc(3, lens[i], ram, &crc);
+        TEST_ASSERT_EQUAL_MEMORY(&nvImage[3], ram, lens[i]);
+        TEST_ASSERT_EQUAL_HEX(Crc32_calc(&nvImage[3], lens[i], 0xffffffff),
+                              crc);
+    }
+}
+
+void
+test_ReadDataInChunks(void)
 {
-    TEST_IGNORE_MESSAGE("Hello world!");
+    Crc32 crc;
+
+    NVMem_readDataCrc(0, 600, ram, &crc);
+    TEST_ASSERT_EQUAL(3, nReads);
+    NVMem_readDataCrc(0, 0, ram, &crc);
+    TEST_ASSERT_EQUAL(3, nReads);
+    TEST_ASSERT_EQUAL_HEX(0, crc);
+}
+
+void
+test_MergeContiguousSegments(void)
+{
+    NVMemSeg segs[] =
+    {
+        {100, 10, &ram[0]}, {110, 20, &ram[10]}, {0, 8, &ram[30]},
+        {8, 8, &ram[40]}
+    };
+
+    NVMem_readv(segs, 4);
+    TEST_ASSERT_EQUAL(3, nReads);
+    TEST_ASSERT_EQUAL_MEMORY(&nvImage[100], &ram[0], 30);
+    TEST_ASSERT_EQUAL_MEMORY(&nvImage[0], &ram[30], 8);
+    TEST_ASSERT_EQUAL_MEMORY(&nvImage[8], &ram[40], 8);
+
+    memset(ram, 0x5a, sizeof(ram));
+    NVMem_writev(segs, 2);
+    NVMem_writev(segs, 0);
+    TEST_ASSERT_EQUAL(1, nStores);
+    TEST_ASSERT_EQUAL_MEMORY(ram, &nvImage[100], 30);
 }
 
 /* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,267 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_aio.c
+ *  \brief  Unit test for the asynchronous file-backed NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  Every test runs with io_uring, when the kernel supports it, and with 
+ *  the thread pool.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "unity.h"
+#include "NVMem_aio.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define IMAGE_SIZE          (64 * 1024)
+#define DEPTH               8
+#define NUM_REQS            40
+#define REQ_SIZE            512
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static const NVMemAioMode modes[] = {NVMEM_AIO_AUTO, NVMEM_AIO_THREADS};
+static char path[] = "/tmp/test_NVMem_aioXXXXXX";
+static uint8_t block[NUM_REQS * REQ_SIZE];
+static uint8_t ram[NUM_REQS * REQ_SIZE];
+static NVMemAioReq reqs[NUM_REQS];
+static int nDone;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+fillBlock(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        block[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void
+countDone(NVMemAioReq *req)
+{
+    TEST_ASSERT_EQUAL(0, req->result);
+    ++nDone;
+}
+
+static void
+submitAll(uint8_t *buf, bool store)
+{
+    int i;
+
+    nDone = 0;
+    for (i = 0; i < NUM_REQS; ++i)
+    {
+        reqs[i].addr = 1000 + (i * REQ_SIZE);
+        reqs[i].nBytes = REQ_SIZE;
+        reqs[i].buf = buf + (i * REQ_SIZE);
+        reqs[i].store = store;
+        reqs[i].done = countDone;
+        reqs[i].ctx = NULL;
+        NVMemAio_submit(&reqs[i]);
+    }
+    while (nDone != NUM_REQS)
+    {
+        NVMemAio_complete(true);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    int fd;
+
+    strcpy(path, "/tmp/test_NVMem_aioXXXXXX");
+    fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+    Crc32_init();
+    fillBlock(0xa10);
+    memset(ram, 0, sizeof(ram));
+}
+
+void
+tearDown(void)
+{
+    NVMemAio_close();
+    unlink(path);
+}
+
+void
+test_StoreAndReadBack(void)
+{
+    uint8_t erased[REQ_SIZE];
+    size_t i;
+
+    memset(erased, NVMEM_AIO_ERASED_VALUE, sizeof(erased));
+    for (i = 0; i < (sizeof(modes) / sizeof(modes[0])); ++i)
+    {
+        TEST_ASSERT_TRUE(NVMemAio_open(path, IMAGE_SIZE, DEPTH, modes[i],
+                                       NVMEM_SYNC_RANGED));
+        NVMem_readData(IMAGE_SIZE - REQ_SIZE, REQ_SIZE, ram);
+        TEST_ASSERT_EQUAL_MEMORY(erased, ram, REQ_SIZE);
+        NVMem_readData(IMAGE_SIZE + 1000, REQ_SIZE, ram);
+        TEST_ASSERT_EQUAL_MEMORY(erased, ram, REQ_SIZE);
+
+        fillBlock(i);
+        NVMem_storeData(7 + i, REQ_SIZE, block);
+        NVMem_readData(7 + i, REQ_SIZE, ram);
+        TEST_ASSERT_EQUAL_MEMORY(block, ram, REQ_SIZE);
+        NVMemAio_close();
+    }
+}
+
+void
+test_SubmitMoreRequestsThanTheDepth(void)
+{
+    size_t i;
+
+    for (i = 0; i < (sizeof(modes) / sizeof(modes[0])); ++i)
+    {
+        TEST_ASSERT_TRUE(NVMemAio_open(path, IMAGE_SIZE, DEPTH, modes[i],
+                                       NVMEM_SYNC_RANGED));
+        fillBlock(0x10 + i);
+        submitAll(block, true);
+        memset(ram, 0, sizeof(ram));
+        submitAll(ram, false);
+        TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+        TEST_ASSERT_EQUAL(0, NVMemAio_complete(false));
+        NVMemAio_close();
+    }
+}
+
+void
+test_TransferThroughARegisteredBuffer(void)
+{
+    size_t i;
+
+    for (i = 0; i < (sizeof(modes) / sizeof(modes[0])); ++i)
+    {
+        TEST_ASSERT_TRUE(NVMemAio_open(path, IMAGE_SIZE, DEPTH, modes[i],
+                                       NVMEM_SYNC_RANGED));
+        TEST_ASSERT_TRUE(NVMemAio_register(ram, sizeof(ram)));
+        fillBlock(0x20 + i);
+        memcpy(ram, block, sizeof(ram));
+        submitAll(ram, true);
+        memset(ram, 0, sizeof(ram));
+        submitAll(ram, false);
+        TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+        NVMemAio_close();
+    }
+}
+
+void
+test_TransferSegmentsAtOnce(void)
+{
+    NVMemSeg segs[NUM_REQS];
+    uint8_t erased[REQ_SIZE];
+    size_t i;
+    int j;
+
+    memset(erased, NVMEM_AIO_ERASED_VALUE, sizeof(erased));
+    for (j = 0; j < NUM_REQS; ++j)
+    {
+        segs[j].addr = (NUM_REQS - 1 - j) * 2 * REQ_SIZE;
+        segs[j].nBytes = REQ_SIZE;
+        segs[j].buf = block + (j * REQ_SIZE);
+    }
+    for (i = 0; i < (sizeof(modes) / sizeof(modes[0])); ++i)
+    {
+        TEST_ASSERT_TRUE(NVMemAio_open(path, IMAGE_SIZE, DEPTH, modes[i],
+                                       NVMEM_SYNC_RANGED));
+        fillBlock(0x30 + i);
+        NVMem_writev(segs, NUM_REQS);
+        for (j = 0; j < NUM_REQS; ++j)
+        {
+            segs[j].buf = ram + (j * REQ_SIZE);
+        }
+        segs[0].addr = IMAGE_SIZE;
+        memset(ram, 0, sizeof(ram));
+        NVMem_readv(segs, NUM_REQS);
+        TEST_ASSERT_EQUAL_MEMORY(erased, ram, REQ_SIZE);
+        TEST_ASSERT_EQUAL_MEMORY(block + REQ_SIZE, ram + REQ_SIZE,
+                                 sizeof(ram) - REQ_SIZE);
+        segs[0].addr = (NUM_REQS - 1) * 2 * REQ_SIZE;
+        for (j = 0; j < NUM_REQS; ++j)
+        {
+            segs[j].buf = block + (j * REQ_SIZE);
+        }
+        NVMemAio_close();
+    }
+}
+
+void
+test_SyncStoresForEveryPolicy(void)
+{
+    static const NVMemSync policies[] =
+    {
+        NVMEM_SYNC_IMMEDIATE, NVMEM_SYNC_RANGED, NVMEM_SYNC_DEFERRED
+    };
+    size_t i, j;
+
+    for (i = 0; i < (sizeof(modes) / sizeof(modes[0])); ++i)
+    {
+        for (j = 0; j < (sizeof(policies) / sizeof(policies[0])); ++j)
+        {
+            TEST_ASSERT_TRUE(NVMemAio_open(path, IMAGE_SIZE, DEPTH, 
+                                           modes[i], policies[j]));
+            fillBlock(0x40 + (i * 4) + j);
+            NVMem_storeData(100 + j, REQ_SIZE, block);
+            submitAll(block, true);
+            TEST_ASSERT_TRUE(NVMemAio_sync());
+            NVMemAio_close();
+
+            TEST_ASSERT_TRUE(NVMemAio_open(path, IMAGE_SIZE, DEPTH, 
+                                           modes[i], policies[j]));
+            NVMem_readData(100 + j, REQ_SIZE, ram);
+            TEST_ASSERT_EQUAL_MEMORY(block, ram, REQ_SIZE);
+            submitAll(ram, false);
+            TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+            NVMemAio_close();
+        }
+    }
+}
+
+void
+test_ReadDataAndCalculateCrc(void)
+{
+    Crc32 crc;
+
+    TEST_ASSERT_TRUE(NVMemAio_open(path, IMAGE_SIZE, DEPTH, 
+                                   NVMEM_AIO_AUTO, NVMEM_SYNC_RANGED));
+    NVMem_storeData(100, 700, block);
+    NVMem_readDataCrc(100, 700, ram, &crc);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 700);
+    TEST_ASSERT_EQUAL_HEX(Crc32_calc(block, 700, 0xffffffff), crc);
+}
+
+/* ------------------------------ End of file ------------------------------ */
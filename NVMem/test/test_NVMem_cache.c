@@ -0,0 +1,247 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_cache.c
+ *  \brief  Unit test for the read cache and write-back buffer of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built with NVMEM_CACHE, so the simulated flash provides the
+ *  device entry points. It is also built with NVMEM_BASE_ADDR, the
+ *  address of the internal flash of a MCU, which must not be read
+ *  directly while the cache holds the latest bytes.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "NVMem_cache.h"
+#include "NVMem_sim.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define LINE                NVMEM_CACHE_LINE
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemCacheStats stats;
+static NVMemSimStats devStats;
+static uint8_t block[NVMEM_CACHE_BYPASS];
+static uint8_t ram[NVMEM_CACHE_BYPASS];
+static uint8_t erased[LINE];
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+fillBlock(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        block[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    NVMemSimCfg cfg = NVMEM_SIM_DFT_CFG;
+
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    NVMemCache_resetStats();
+    fillBlock(0xcace);
+    memset(erased, NVMEM_SIM_ERASED_VALUE, sizeof(erased));
+}
+
+void
+tearDown(void)
+{
+    NVMemCache_invalidate();
+    NVMemSim_close();
+}
+
+void
+test_ReadCachedLines(void)
+{
+    NVMemDev_storeData(LINE + 10, 100, block);
+    NVMemSim_resetStats();
+
+    NVMem_readData(LINE + 10, 100, ram);
+    NVMem_readData(LINE + 20, 16, ram + 100);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 100);
+    TEST_ASSERT_EQUAL_MEMORY(block + 10, ram + 100, 16);
+
+    NVMemCache_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.nMisses);
+    TEST_ASSERT_EQUAL(1, stats.nHits);
+    NVMemSim_getStats(&devStats);
+    TEST_ASSERT_EQUAL(LINE, devStats.bytesRead);
+}
+
+void
+test_HoldStoresUntilFlush(void)
+{
+    NVMem_storeData(30, 10, block);
+    NVMem_readData(30, 10, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 10);
+    NVMemDev_readData(30, 10, ram);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram, 10);
+
+    NVMem_flush();
+    NVMemDev_readData(30, 10, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 10);
+    NVMemCache_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.nBursts);
+    TEST_ASSERT_EQUAL(LINE, stats.bytesWritten);
+}
+
+void
+test_MergeAdjacentStoresIntoBursts(void)
+{
+    uint32_t addr;
+
+    for (addr = 0; addr < ((NVMEM_CACHE_BURST_LINES + 1) * LINE);
+         addr += 64)
+    {
+        NVMem_storeData(addr, 64, block + addr);
+    }
+    NVMem_storeData(0, 64, block);
+    NVMem_flush();
+
+    NVMemCache_getStats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.nBursts);
+    TEST_ASSERT_EQUAL((NVMEM_CACHE_BURST_LINES + 1) * LINE,
+                      stats.bytesWritten);
+    NVMemSim_getStats(&devStats);
+    TEST_ASSERT_EQUAL(NVMEM_CACHE_BURST_LINES + 1, devStats.nPrograms);
+    TEST_ASSERT_EQUAL(0, devStats.nErases);
+
+    NVMemDev_readData(0, (NVMEM_CACHE_BURST_LINES + 1) * LINE, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram,
+                             (NVMEM_CACHE_BURST_LINES + 1) * LINE);
+}
+
+void
+test_FlushWhenTooManyLinesAreDirty(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < (NVMEM_CACHE_DIRTY_MAX - 1); ++i)
+    {
+        NVMem_storeData(i * 2 * LINE, 1, block);
+    }
+    NVMemSim_getStats(&devStats);
+    TEST_ASSERT_EQUAL(0, devStats.bytesStored);
+
+    NVMem_storeData(i * 2 * LINE, 1, block);
+    NVMemSim_getStats(&devStats);
+    TEST_ASSERT_EQUAL(NVMEM_CACHE_DIRTY_MAX * LINE, devStats.bytesStored);
+    NVMemCache_getStats(&stats);
+    TEST_ASSERT_EQUAL(NVMEM_CACHE_DIRTY_MAX, stats.nBursts);
+}
+
+void
+test_WriteBackEvictedLines(void)
+{
+    uint32_t i;
+
+    NVMem_storeData(0, 8, block);
+    for (i = 1; i <= NVMEM_CACHE_LINES; ++i)
+    {
+        NVMem_readData(i * LINE, 1, ram);
+    }
+    NVMemDev_readData(0, 8, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 8);
+    NVMemCache_getStats(&stats);
+    TEST_ASSERT_EQUAL(NVMEM_CACHE_LINES + 1, stats.nMisses);
+    TEST_ASSERT_EQUAL(1, stats.nBursts);
+}
+
+void
+test_BypassLargeReadsKeepingCachedStores(void)
+{
+    NVMemDev_storeData(0, sizeof(block), block);
+    NVMem_readData(LINE, 1, ram);
+    NVMem_storeData(LINE - 4, 8, erased);
+    NVMemCache_resetStats();
+
+    NVMem_readData(0, sizeof(ram), ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, LINE - 4);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram + LINE - 4, 8);
+    TEST_ASSERT_EQUAL_MEMORY(block + LINE + 4, ram + LINE + 4,
+                             sizeof(ram) - LINE - 4);
+    NVMemCache_getStats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.nHits + stats.nMisses);
+}
+
+void
+test_ElideStoresMatchingTheCachedBytes(void)
+{
+    NVMem_storeData(10, 100, block);
+    NVMem_flush();
+    NVMemCache_resetStats();
+
+    NVMem_storeData(10, 100, block);
+    NVMem_storeData(LINE, LINE, erased);
+    NVMem_flush();
+    NVMemCache_getStats(&stats);
+#if defined(NVMEM_ELIDE)
+    TEST_ASSERT_EQUAL(100 + LINE, stats.bytesElided);
+    TEST_ASSERT_EQUAL(0, stats.bytesWritten);
+#else
+    TEST_ASSERT_EQUAL(100, stats.bytesElided);
+    TEST_ASSERT_EQUAL(LINE, stats.bytesWritten);
+#endif
+}
+
+void
+test_InvalidateAfterFlushing(void)
+{
+    NVMem_storeData(LINE, 4, block);
+    NVMemCache_invalidate();
+    NVMemDev_storeData(LINE + 8, 4, block);
+    NVMemCache_resetStats();
+
+    NVMem_readData(LINE, 12, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 4);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram + 8, 4);
+    NVMemCache_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.nMisses);
+}
+
+void
+test_ReadDataAndCalculateCrcFromDirtyLines(void)
+{
+    Crc32 crc;
+
+    Crc32_init();
+    NVMem_storeData(LINE + 5, 100, block);
+    NVMem_readDataCrc(LINE + 5, 100, ram, &crc);
+
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 100);
+    TEST_ASSERT_EQUAL_HEX(Crc32_calc(block, 100, 0xffffffff), crc);
+    TEST_ASSERT_NULL(NVMem_map(LINE + 5, 100));
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,253 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_eeprom.c
+ *  \brief  Unit test for the page-aware serial EEPROM back-end.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The back-end runs on top of NVMem_eepromSim.c. The benchmark saves a
+ *  block of fields both through NVMem_writev() and as a naive driver
+ *  would, one page write per field followed by the worst-case write
+ *  cycle of the datasheet.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "NVMem_eeprom.h"
+#include "NVMem_eepromSim.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define WRITE_NS_MAX        5000000
+#define NUM_FIELDS          16
+#define FIELD_LEN           8
+#define NUM_UPDATES         50
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static const NVMemEepromSimCfg i2cCfg = NVMEM_EEPROM_SIM_I2C_CFG;
+static const NVMemEepromSimCfg spiCfg = NVMEM_EEPROM_SIM_SPI_CFG;
+static NVMemEepromSimStats simStats;
+static NVMemEepromStats stats;
+static uint8_t block[512];
+static uint8_t ram[512];
+static uint8_t fields[NUM_FIELDS][FIELD_LEN * 2];
+static NVMemSeg segs[NUM_FIELDS];
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+setFields(uint32_t base, uint8_t value)
+{
+    int i;
+
+    for (i = 0; i < NUM_FIELDS; ++i)
+    {
+        memset(fields[i], value + i, FIELD_LEN);
+        segs[i].addr = base + (uint32_t)i * FIELD_LEN;
+        segs[i].nBytes = FIELD_LEN;
+        segs[i].buf = fields[i];
+    }
+}
+
+static void
+storeNaive(void)
+{
+    int i;
+
+    for (i = 0; i < NUM_FIELDS; ++i)
+    {
+        NVMemEeprom_busWrite(segs[i].addr, segs[i].nBytes, segs[i].buf);
+        NVMemEepromSim_wait(WRITE_NS_MAX);
+    }
+}
+
+static void
+storeBatched(void)
+{
+    NVMem_writev(segs, NUM_FIELDS);
+}
+
+static uint64_t
+run(const char *what, const NVMemEepromSimCfg *cfg, void (*store)(void))
+{
+    uint64_t ns;
+    int i;
+
+    TEST_ASSERT_TRUE(NVMemEepromSim_open(cfg));
+    for (i = 0; i < NUM_UPDATES; ++i)
+    {
+        setFields(1024, (uint8_t)i);
+        store();
+    }
+    NVMem_readData(1024, NUM_FIELDS * FIELD_LEN, ram);
+    for (i = 0; i < NUM_FIELDS; ++i)
+    {
+        TEST_ASSERT_EQUAL_MEMORY(fields[i], &ram[i * FIELD_LEN], FIELD_LEN);
+    }
+
+    ns = NVMemEepromSim_now();
+    NVMemEepromSim_getStats(&simStats);
+    printf("%-14s %8.1f ms, %5u page writes, %6u polls\n",
+           what, ns / 1e6, simStats.nPageWrites, simStats.nPolls);
+    TEST_ASSERT_EQUAL(0, simStats.nViolations);
+    return ns;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    size_t i;
+
+    TEST_ASSERT_TRUE(NVMemEepromSim_open(&i2cCfg));
+    NVMemEeprom_resetStats();
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        block[i] = (uint8_t)(i * 7);
+    }
+}
+
+void
+tearDown(void)
+{
+    NVMemEepromSim_close();
+}
+
+void
+test_SplitStoresAtPageBoundaries(void)
+{
+    NVMem_storeData(100, 300, block);
+    NVMem_readData(100, 300, ram);
+
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 300);
+    NVMemEepromSim_getStats(&simStats);
+    TEST_ASSERT_EQUAL(4, simStats.nPageWrites);
+    TEST_ASSERT_EQUAL(0, simStats.nViolations);
+    NVMem_readData(96, 4, ram);
+    TEST_ASSERT_EACH_EQUAL_HEX8(NVMEM_EEPROM_ERASED_VALUE, ram, 4);
+}
+
+void
+test_PollInsteadOfWaiting(void)
+{
+    NVMem_storeData(0, 16, block);
+    TEST_ASSERT_TRUE(NVMemEepromSim_now() < i2cCfg.writeNs);
+
+    NVMem_storeData(16, 16, block);
+    NVMemEeprom_getStats(&stats);
+    NVMemEepromSim_getStats(&simStats);
+    TEST_ASSERT_TRUE(stats.nPolls > 0);
+    TEST_ASSERT_EQUAL(0, stats.nTimeouts);
+    TEST_ASSERT_EQUAL(0, simStats.nViolations);
+    TEST_ASSERT_TRUE(NVMemEepromSim_now() >= i2cCfg.writeNs);
+    TEST_ASSERT_TRUE(NVMemEepromSim_now() < 2 * i2cCfg.writeNs);
+}
+
+void
+test_BatchAdjacentSegmentsInAPageWrite(void)
+{
+    setFields(0, 0x10);
+    NVMem_writev(segs, NUM_FIELDS);
+
+    NVMemEepromSim_getStats(&simStats);
+    TEST_ASSERT_EQUAL(1, simStats.nPageWrites);
+    NVMem_readData(0, NUM_FIELDS * FIELD_LEN, ram);
+    TEST_ASSERT_EQUAL_MEMORY(fields[0], ram, FIELD_LEN);
+    TEST_ASSERT_EQUAL_MEMORY(fields[NUM_FIELDS - 1],
+                             &ram[(NUM_FIELDS - 1) * FIELD_LEN], FIELD_LEN);
+}
+
+void
+test_FillTheGapsBetweenSegments(void)
+{
+    NVMem_storeData(0, 32, block);
+    setFields(0, 0x40);
+    segs[1].addr = 16;
+    NVMemEepromSim_resetStats();
+    NVMem_writev(segs, 2);
+
+    NVMemEepromSim_getStats(&simStats);
+    NVMemEeprom_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, simStats.nPageWrites);
+    TEST_ASSERT_EQUAL(FIELD_LEN, stats.bytesFilled);
+    NVMem_readData(0, 32, ram);
+    TEST_ASSERT_EQUAL_MEMORY(fields[0], ram, FIELD_LEN);
+    TEST_ASSERT_EQUAL_MEMORY(&block[8], &ram[8], 8);
+    TEST_ASSERT_EQUAL_MEMORY(fields[1], &ram[16], FIELD_LEN);
+    TEST_ASSERT_EQUAL_MEMORY(&block[24], &ram[24], 8);
+}
+
+void
+test_DropAPageWhoseGapCanNotBeRead(void)
+{
+    NVMem_storeData(0, 32, block);
+    setFields(0, 0x40);
+    segs[1].addr = 16;
+    segs[2].addr = 200;
+    NVMemEepromSim_resetStats();
+    NVMemEepromSim_nack(1);
+    NVMem_writev(segs, 3);
+
+    NVMemEepromSim_getStats(&simStats);
+    NVMemEeprom_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, simStats.nPageWrites);
+    TEST_ASSERT_EQUAL(1, stats.nDropped);
+    NVMem_readData(0, 32, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 32);
+    NVMem_readData(200, FIELD_LEN, ram);
+    TEST_ASSERT_EQUAL_MEMORY(fields[2], ram, FIELD_LEN);
+}
+
+void
+test_DropAPageWriteNotAcknowledged(void)
+{
+    NVMemEepromSim_nack(1);
+    NVMem_storeData(0, 16, block);
+
+    NVMemEepromSim_getStats(&simStats);
+    NVMemEeprom_getStats(&stats);
+    TEST_ASSERT_EQUAL(0, simStats.nPageWrites);
+    TEST_ASSERT_EQUAL(1, stats.nDropped);
+    NVMem_readData(0, 16, ram);
+    NVMemEeprom_getStats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.nPolls);
+    TEST_ASSERT_EACH_EQUAL_HEX8(NVMEM_EEPROM_ERASED_VALUE, ram, 16);
+}
+
+void
+test_CompareWithANaiveDriver(void)
+{
+    uint64_t naive, batched;
+
+    naive = run("i2c naive", &i2cCfg, storeNaive);
+    batched = run("i2c batched", &i2cCfg, storeBatched);
+    TEST_ASSERT_TRUE(batched * 3 < naive);
+
+    naive = run("spi naive", &spiCfg, storeNaive);
+    batched = run("spi batched", &spiCfg, storeBatched);
+    TEST_ASSERT_TRUE(batched * 3 < naive);
+}
+
+/* ------------------------------ End of file ------------------------------ */
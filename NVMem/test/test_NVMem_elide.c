@@ -0,0 +1,139 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_elide.c
+ *  \brief  Unit test for the write elision of NVMem by reading back.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built with NVMEM_ELIDE, so the simulated flash provides the
+ *  device entry points.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "NVMem.h"
+#include "NVMem_sim.h"
+
+TEST_FILE("NVMem_elide.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define CHUNK               64
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemStats stats;
+static NVMemSimStats devStats;
+static uint8_t block[600];
+static uint8_t ram[600];
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+fillBlock(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        block[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void
+resetStats(void)
+{
+    NVMem_resetStats();
+    NVMemSim_resetStats();
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    NVMemSimCfg cfg = NVMEM_SIM_DFT_CFG;
+
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    resetStats();
+    fillBlock(0xe1);
+}
+
+void
+tearDown(void)
+{
+    NVMemSim_close();
+}
+
+void
+test_ElideUnchangedStores(void)
+{
+    NVMem_storeData(100, sizeof(block), block);
+    resetStats();
+
+    NVMem_storeData(100, sizeof(block), block);
+    NVMem_getStats(&stats);
+    TEST_ASSERT_EQUAL(sizeof(block), stats.bytesStored);
+    TEST_ASSERT_EQUAL(sizeof(block), stats.bytesElided);
+    NVMemSim_getStats(&devStats);
+    TEST_ASSERT_EQUAL(0, devStats.bytesStored);
+    TEST_ASSERT_EQUAL(0, devStats.nPrograms);
+    TEST_ASSERT_EQUAL(0, devStats.nErases);
+}
+
+void
+test_StoreOnlyChangedChunks(void)
+{
+    NVMem_storeData(0, 8 * CHUNK, block);
+    resetStats();
+
+    block[CHUNK + 6] ^= 0x01;
+    block[(4 * CHUNK) + 44] ^= 0x80;
+    block[(5 * CHUNK) + 1] ^= 0x80;
+    NVMem_storeData(0, 8 * CHUNK, block);
+    NVMem_getStats(&stats);
+    TEST_ASSERT_EQUAL(5 * CHUNK, stats.bytesElided);
+    NVMemSim_getStats(&devStats);
+    TEST_ASSERT_EQUAL(3 * CHUNK, devStats.bytesStored);
+
+    NVMem_readData(0, 8 * CHUNK, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 8 * CHUNK);
+}
+
+void
+test_CompareUnalignedStoresByChunks(void)
+{
+    NVMem_storeData(CHUNK - 10, 20, block);
+    resetStats();
+
+    NVMem_storeData(CHUNK - 10, 20, block);
+    NVMem_getStats(&stats);
+    TEST_ASSERT_EQUAL(20, stats.bytesElided);
+
+    block[15] ^= 0x01;
+    NVMem_storeData(CHUNK - 10, 20, block);
+    NVMem_getStats(&stats);
+    TEST_ASSERT_EQUAL(30, stats.bytesElided);
+    NVMemSim_getStats(&devStats);
+    TEST_ASSERT_EQUAL(10, devStats.bytesStored);
+    NVMem_readData(CHUNK - 10, 20, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 20);
+}
+
+/* ------------------------------ End of file ------------------------------ */
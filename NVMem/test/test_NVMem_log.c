@@ -0,0 +1,236 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_log.c
+ *  \brief  Unit test for the log-structured record store on top of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The store runs on top of NVMem_sim.c, so that the cost of updating a
+ *  record can be compared against the one of overwriting it in place.
+ *  It is printed, in simulated time, for the default geometry and timing
+ *  of NVMem_sim.h.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "NVMem_log.h"
+#include "NVMem_sim.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define LOG_ADDR            NVMEM_PART_ADDR(LOG)
+#define LOG_SECTORS         (NVMEM_PART_SIZE(LOG) / NVMEM_SECTOR_SIZE)
+#define NUM_IDS             4
+#define NUM_UPDATES         100
+#define REC_LEN             32
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemSimStats simStats;
+static NVMemLogStats stats;
+static uint8_t values[NUM_IDS][NVMEM_LOG_MAX_LEN];
+static uint16_t lens[NUM_IDS];
+static uint8_t ram[NVMEM_LOG_MAX_LEN];
+static uint32_t seed;
+static uint64_t start;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static uint32_t
+rnd(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static void
+fill(uint16_t id, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; ++i)
+    {
+        values[id][i] = (uint8_t)rnd();
+    }
+    lens[id] = len;
+}
+
+static void
+update(uint16_t id, uint16_t len)
+{
+    fill(id, len);
+    TEST_ASSERT_TRUE(NVMemLog_write(id, values[id], len));
+}
+
+static void
+checkAll(void)
+{
+    uint16_t id, len;
+
+    for (id = 0; id < NUM_IDS; ++id)
+    {
+        TEST_ASSERT_TRUE(NVMemLog_read(id, ram, sizeof(ram), &len));
+        TEST_ASSERT_EQUAL(lens[id], len);
+        TEST_ASSERT_EQUAL_MEMORY(values[id], ram, len);
+    }
+}
+
+static void
+begin(void)
+{
+    NVMemSim_resetStats();
+    start = NVMemSim_now();
+}
+
+static void
+report(const char *what)
+{
+    NVMemSim_getStats(&simStats);
+    printf("%-12s %8.3f ms, %u page programs, %u erases, "
+           "write amplification %.1f\n",
+           what, (NVMemSim_now() - start) / 1e6, simStats.nPrograms,
+           simStats.nErases,
+           (simStats.bytesStored != 0) ?
+               (double)simStats.bytesProgrammed / simStats.bytesStored :
+               0.0);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    NVMemSimCfg cfg = NVMEM_SIM_DFT_CFG;
+
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    TEST_ASSERT_TRUE(NVMemLog_open(LOG_ADDR, LOG_SECTORS));
+    NVMemLog_resetStats();
+    seed = 0x10c;
+}
+
+void
+tearDown(void)
+{
+    NVMemSim_close();
+}
+
+void
+test_ReadTheLatestRecord(void)
+{
+    uint16_t len;
+
+    TEST_ASSERT_FALSE(NVMemLog_read(1, ram, sizeof(ram), &len));
+    TEST_ASSERT_TRUE(NVMemLog_write(1, "first", 5));
+    TEST_ASSERT_TRUE(NVMemLog_write(1, "second", 6));
+    TEST_ASSERT_TRUE(NVMemLog_read(1, ram, sizeof(ram), &len));
+    TEST_ASSERT_EQUAL(6, len);
+    TEST_ASSERT_EQUAL_MEMORY("second", ram, 6);
+    TEST_ASSERT_FALSE(NVMemLog_read(1, ram, 5, &len));
+    TEST_ASSERT_FALSE(NVMemLog_write(NVMEM_LOG_MAX_IDS, "x", 1));
+    TEST_ASSERT_FALSE(NVMemLog_write(2, ram, NVMEM_LOG_MAX_LEN + 1));
+}
+
+void
+test_RecoverTheLatestRecordsAtOpen(void)
+{
+    uint16_t id;
+
+    for (id = 0; id < NUM_IDS; ++id)
+    {
+        update(id, (uint16_t)(id + 1));
+        update(id, (uint16_t)(id * 8));
+    }
+    TEST_ASSERT_TRUE(NVMemLog_open(LOG_ADDR, LOG_SECTORS));
+    checkAll();
+}
+
+void
+test_IgnoreACorruptRecord(void)
+{
+    uint8_t zero = 0;
+    uint16_t len;
+
+    TEST_ASSERT_TRUE(NVMemLog_write(1, "good", 4));
+    TEST_ASSERT_TRUE(NVMemLog_write(1, "torn", 4));
+
+    /* the payload of the second record, after its 12-byte header */
+    NVMem_storeData(LOG_ADDR + 12 + 16 + 12, 1, &zero);
+    TEST_ASSERT_TRUE(NVMemLog_open(LOG_ADDR, LOG_SECTORS));
+    TEST_ASSERT_TRUE(NVMemLog_read(1, ram, sizeof(ram), &len));
+    TEST_ASSERT_EQUAL_MEMORY("good", ram, 4);
+
+    TEST_ASSERT_TRUE(NVMemLog_write(1, "next", 4));
+    TEST_ASSERT_TRUE(NVMemLog_open(LOG_ADDR, LOG_SECTORS));
+    TEST_ASSERT_TRUE(NVMemLog_read(1, ram, sizeof(ram), &len));
+    TEST_ASSERT_EQUAL_MEMORY("next", ram, 4);
+}
+
+void
+test_CollectFullSectors(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < 2000; ++i)
+    {
+        update((uint16_t)(rnd() % NUM_IDS),
+               (uint16_t)(rnd() % (NVMEM_LOG_MAX_LEN + 1)));
+        if ((i % 150) == 0)
+        {
+            TEST_ASSERT_TRUE(NVMemLog_open(LOG_ADDR, LOG_SECTORS));
+        }
+    }
+    checkAll();
+    TEST_ASSERT_TRUE(NVMemLog_open(LOG_ADDR, LOG_SECTORS));
+    checkAll();
+
+    NVMemLog_getStats(&stats);
+    NVMemSim_getStats(&simStats);
+    TEST_ASSERT_TRUE(stats.nCollections > LOG_SECTORS);
+    TEST_ASSERT_EQUAL(stats.nCollections, simStats.nErases);
+    TEST_ASSERT_EQUAL(0, simStats.nViolations);
+}
+
+void
+test_UpdateCheaperThanInPlace(void)
+{
+    uint32_t i, inPlaceErases;
+
+    begin();
+    for (i = 0; i < NUM_UPDATES; ++i)
+    {
+        fill(0, REC_LEN);
+        NVMem_storeData(0, REC_LEN, values[0]);
+    }
+    report("in place");
+    inPlaceErases = simStats.nErases;
+
+    begin();
+    for (i = 0; i < NUM_UPDATES; ++i)
+    {
+        update(0, REC_LEN);
+    }
+    report("log");
+    TEST_ASSERT_TRUE((simStats.nErases * 10) < inPlaceErases);
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,188 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_mmap.c
+ *  \brief  Unit test for the POSIX file-backed NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/* ----------------------------- Include files ----------------------------- */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "unity.h"
+#include "NVMem_mmap.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define IMAGE_SIZE          8192
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static char path[] = "/tmp/test_NVMem_mmapXXXXXX";
+static uint8_t block[600];
+static uint8_t ram[600];
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+fillBlock(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        block[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void
+readFile(off_t offset, uint8_t *to, size_t nBytes)
+{
+    FILE *file;
+
+    file = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(0, fseek(file, offset, SEEK_SET));
+    TEST_ASSERT_EQUAL(nBytes, fread(to, 1, nBytes, file));
+    fclose(file);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    int fd;
+
+    strcpy(path, "/tmp/test_NVMem_mmapXXXXXX");
+    fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+    Crc32_init();
+    fillBlock(0xb0);
+    memset(ram, 0, sizeof(ram));
+}
+
+void
+tearDown(void)
+{
+    NVMemMmap_close();
+    unlink(path);
+}
+
+void
+test_NewImageReadsAsErased(void)
+{
+    uint8_t erased[sizeof(ram)];
+
+    TEST_ASSERT_TRUE(NVMemMmap_open(path, IMAGE_SIZE, NVMEM_SYNC_RANGED));
+    memset(erased, NVMEM_ERASED_VALUE, sizeof(erased));
+    NVMem_readData(IMAGE_SIZE - sizeof(ram), sizeof(ram), ram);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram, sizeof(ram));
+}
+
+void
+test_StoreAndReadBackForEverySyncPolicy(void)
+{
+    static const NVMemSync policies[] =
+    {
+        NVMEM_SYNC_IMMEDIATE, NVMEM_SYNC_RANGED, NVMEM_SYNC_DEFERRED
+    };
+    size_t i;
+
+    for (i = 0; i < (sizeof(policies) / sizeof(policies[0])); ++i)
+    {
+        TEST_ASSERT_TRUE(NVMemMmap_open(path, IMAGE_SIZE, policies[i]));
+        fillBlock(i);
+        NVMem_storeData(4000 + i, sizeof(block), block);
+        NVMem_readData(4000 + i, sizeof(block), ram);
+        TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+        TEST_ASSERT_TRUE(NVMemMmap_sync());
+        memset(ram, 0, sizeof(ram));
+        readFile(4000 + i, ram, sizeof(ram));
+        TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+    }
+}
+
+void
+test_KeepDataAcrossReopen(void)
+{
+    TEST_ASSERT_TRUE(NVMemMmap_open(path, IMAGE_SIZE, NVMEM_SYNC_DEFERRED));
+    NVMem_storeData(512, sizeof(block), block);
+    NVMem_storeData(16, 32, block);
+    NVMemMmap_close();
+
+    TEST_ASSERT_TRUE(NVMemMmap_open(path, IMAGE_SIZE, NVMEM_SYNC_DEFERRED));
+    NVMem_readData(512, sizeof(block), ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+    NVMem_readData(16, 32, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 32);
+}
+
+void
+test_IgnoreAccessOutOfTheImage(void)
+{
+    uint8_t erased[sizeof(ram)];
+
+    memset(erased, NVMEM_ERASED_VALUE, sizeof(erased));
+    NVMem_readData(0, sizeof(ram), ram);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram, sizeof(ram));
+
+    TEST_ASSERT_TRUE(NVMemMmap_open(path, IMAGE_SIZE, NVMEM_SYNC_RANGED));
+    NVMem_storeData(IMAGE_SIZE - 10, 20, block);
+    NVMem_readData(IMAGE_SIZE - 10, 10, ram);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram, 10);
+    NVMem_readData(0xfffffff0, 32, ram);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram, 32);
+}
+
+void
+test_MapStoredBytes(void)
+{
+#if NVMEM_MAP_BY_DEV == 1
+    const uint8_t *mapped;
+
+    TEST_ASSERT_NULL(NVMem_map(0, 16));
+    TEST_ASSERT_TRUE(NVMemMmap_open(path, IMAGE_SIZE, NVMEM_SYNC_DEFERRED));
+    NVMem_storeData(100, sizeof(block), block);
+    mapped = NVMem_map(100, sizeof(block));
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_EQUAL_MEMORY(block, mapped, sizeof(block));
+    TEST_ASSERT_NOT_NULL(NVMem_map(IMAGE_SIZE - 1, 1));
+    TEST_ASSERT_NULL(NVMem_map(IMAGE_SIZE - 1, 2));
+#else
+    TEST_IGNORE_MESSAGE("Built without NVMEM_DEV_MAP");
+#endif
+}
+
+void
+test_ReadDataAndCalculateCrc(void)
+{
+    Crc32 crc;
+
+    TEST_ASSERT_TRUE(NVMemMmap_open(path, IMAGE_SIZE, NVMEM_SYNC_RANGED));
+    NVMem_storeData(100, sizeof(block), block);
+    NVMem_readDataCrc(100, sizeof(block), ram, &crc);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+    TEST_ASSERT_EQUAL_HEX(Crc32_calc(block, sizeof(block), 0xffffffff), crc);
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,79 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_part.c
+ *  \brief  Unit test for the partition table of the non-volatile memory.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It defines its own table, mixing sector and page aligned regions.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include "unity.h"
+
+#define NVMEM_PART_TABLE(X) \
+    X(BOOT_FLAGS,   10,                 NVMEM_PAGE_SIZE) \
+    X(LOG_INDEX,    300,                NVMEM_PAGE_SIZE) \
+    X(SETTINGS,     100,                NVMEM_SECTOR_SIZE) \
+    X(LOG,          3 * NVMEM_SECTOR_SIZE, NVMEM_SECTOR_SIZE) \
+    X(COUNTERS,     NVMEM_PAGE_SIZE,    NVMEM_PAGE_SIZE)
+
+#include "NVMem_part.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+}
+
+void
+tearDown(void)
+{
+}
+
+void
+test_LayOutRegionsInOrder(void)
+{
+    TEST_ASSERT_EQUAL(5, NVMEM_NUM_PARTS);
+    TEST_ASSERT_EQUAL(0, NVMEM_PART_ID(BOOT_FLAGS));
+    TEST_ASSERT_EQUAL(4, NVMEM_PART_ID(COUNTERS));
+
+    TEST_ASSERT_EQUAL(0, NVMEM_PART_ADDR(BOOT_FLAGS));
+    TEST_ASSERT_EQUAL(NVMEM_PAGE_SIZE, NVMEM_PART_SIZE(BOOT_FLAGS));
+    TEST_ASSERT_EQUAL(NVMEM_PAGE_SIZE, NVMEM_PART_ADDR(LOG_INDEX));
+    TEST_ASSERT_EQUAL(2 * NVMEM_PAGE_SIZE, NVMEM_PART_SIZE(LOG_INDEX));
+}
+
+void
+test_KeepSectorAlignedRegionsInTheirOwnSectors(void)
+{
+    TEST_ASSERT_EQUAL(NVMEM_SECTOR_SIZE, NVMEM_PART_ADDR(SETTINGS));
+    TEST_ASSERT_EQUAL(NVMEM_SECTOR_SIZE, NVMEM_PART_SIZE(SETTINGS));
+    TEST_ASSERT_EQUAL(2 * NVMEM_SECTOR_SIZE, NVMEM_PART_ADDR(LOG));
+    TEST_ASSERT_EQUAL(5 * NVMEM_SECTOR_SIZE, NVMEM_PART_ADDR(COUNTERS));
+    TEST_ASSERT_EQUAL((5 * NVMEM_SECTOR_SIZE) + NVMEM_PAGE_SIZE,
+                      NVMEM_PART_END);
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,207 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_queue.c
+ *  \brief  Unit test for the asynchronous store queue of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  NVMem_storeData() is implemented here on top of a RAM image. It can
+ *  be held, so that the queue fills up while a store is being done.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "NVMem_queue.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+#if NVMEM_QUEUE_THREAD == 1
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* ----------------------------- Local macros ------------------------------ */
+#define LOAD(p)                 __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE(p, v)             __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* ------------------------------- Constants ------------------------------- */
+#define NUM_PRODUCERS       2
+#define NUM_STORES          200
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint8_t nvImage[NUM_PRODUCERS * NUM_STORES];
+static uint8_t values[NUM_STORES];
+static int order[NUM_STORES];
+static int nCalls;
+static int nStores;
+static bool hold;
+static bool holding;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+done(void *ctx)
+{
+    order[nCalls++] = (int)(intptr_t)ctx;
+}
+
+#if NVMEM_QUEUE_THREAD == 1
+static void *
+producer(void *arg)
+{
+    uint32_t i, base;
+
+    base = (uint32_t)(intptr_t)arg * NUM_STORES;
+    for (i = 0; i < NUM_STORES; ++i)
+    {
+        while (!NVMem_storeDataAsync(base + i, 1, &values[i],
+                                     (NVMemStoreDone)0, NULL))
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+#endif
+
+/* ---------------------------- Global functions --------------------------- */
+void
+NVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    memcpy(to, &nvImage[from], nBytes);
+}
+
+void
+NVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    STORE(&holding, true);
+    while (LOAD(&hold))
+    {
+    }
+    TEST_ASSERT_TRUE((to + nBytes) <= sizeof(nvImage));
+    memcpy(&nvImage[to], from, nBytes);
+    ++nStores;
+    STORE(&holding, false);
+}
+
+void
+setUp(void)
+{
+    uint32_t i;
+
+    memset(nvImage, 0, sizeof(nvImage));
+    for (i = 0; i < NUM_STORES; ++i)
+    {
+        values[i] = (uint8_t)(i + 1);
+    }
+    nCalls = nStores = 0;
+    hold = holding = false;
+    TEST_ASSERT_TRUE(NVMemQueue_open());
+}
+
+void
+tearDown(void)
+{
+    STORE(&hold, false);
+    NVMemQueue_close();
+}
+
+void
+test_StoreInOrderAndCallBack(void)
+{
+    int i;
+
+    for (i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_TRUE(NVMem_storeDataAsync(8, 2, &values[i * 2], done,
+                                              (void *)(intptr_t)i));
+    }
+    NVMem_sync();
+    TEST_ASSERT_EQUAL(3, nStores);
+    TEST_ASSERT_EQUAL(3, nCalls);
+    TEST_ASSERT_EQUAL(0, order[0]);
+    TEST_ASSERT_EQUAL(1, order[1]);
+    TEST_ASSERT_EQUAL(2, order[2]);
+    TEST_ASSERT_EQUAL_MEMORY(&values[4], &nvImage[8], 2);
+}
+
+void
+test_RejectWhenFull(void)
+{
+    uint32_t i, n;
+
+    STORE(&hold, true);
+    TEST_ASSERT_TRUE(NVMem_storeDataAsync(0, 1, values, done, NULL));
+#if NVMEM_QUEUE_THREAD == 1
+    /* the store being done leaves the queue */
+    while (!LOAD(&holding))
+    {
+        sched_yield();
+    }
+    n = NVMEM_QUEUE_SIZE;
+#else
+    n = NVMEM_QUEUE_SIZE - 1;
+#endif
+    for (i = 1; i <= n; ++i)
+    {
+        TEST_ASSERT_TRUE(NVMem_storeDataAsync(i, 1, &values[i], done,
+                                              NULL));
+    }
+    TEST_ASSERT_FALSE(NVMem_storeDataAsync(i, 1, &values[i], done, NULL));
+
+    STORE(&hold, false);
+    NVMem_sync();
+    TEST_ASSERT_EQUAL(nCalls, nStores);
+    TEST_ASSERT_TRUE(NVMem_storeDataAsync(i, 1, &values[i], done, NULL));
+    NVMem_sync();
+    TEST_ASSERT_EQUAL_MEMORY(values, nvImage, i + 1);
+}
+
+void
+test_SyncStoresOfSeveralProducers(void)
+{
+#if NVMEM_QUEUE_THREAD == 1
+    pthread_t producers[NUM_PRODUCERS];
+    intptr_t i;
+
+    for (i = 0; i < NUM_PRODUCERS; ++i)
+    {
+        TEST_ASSERT_EQUAL(0, pthread_create(&producers[i], NULL, producer,
+                                            (void *)i));
+    }
+    for (i = 0; i < NUM_PRODUCERS; ++i)
+    {
+        pthread_join(producers[i], NULL);
+    }
+    NVMem_sync();
+    TEST_ASSERT_EQUAL(NUM_PRODUCERS * NUM_STORES, nStores);
+    for (i = 0; i < NUM_PRODUCERS; ++i)
+    {
+        TEST_ASSERT_EQUAL_MEMORY(values, &nvImage[i * NUM_STORES],
+                                 NUM_STORES);
+    }
+#else
+    TEST_IGNORE_MESSAGE("Drained from the idle hook");
+#endif
+}
+
+/* ------------------------------ End of file ------------------------------ */
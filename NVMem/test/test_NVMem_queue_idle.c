@@ -0,0 +1,147 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_queue_idle.c
+ *  \brief  Unit test for the asynchronous store queue of NVMem, drained
+ *          by the application.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built with NVMEM_QUEUE_THREAD set to 0, as on a MCU, so the
+ *  queue is drained by NVMemQueue_drain() and NVMem_sync().
+ *  NVMem_storeData() is implemented here on top of a RAM image.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "NVMem_queue.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+#if NVMEM_QUEUE_THREAD != 0
+#error "test_NVMem_queue_idle.c requires NVMEM_QUEUE_THREAD=0"
+#endif
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define IMAGE_SIZE          64
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static uint8_t nvImage[IMAGE_SIZE];
+static uint8_t values[IMAGE_SIZE];
+static int order[NVMEM_QUEUE_SIZE];
+static int nCalls;
+static int nStores;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+done(void *ctx)
+{
+    order[nCalls++] = (int)(intptr_t)ctx;
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+NVMem_readData(uint32_t from, uint32_t nBytes, uint8_t *to)
+{
+    memcpy(to, &nvImage[from], nBytes);
+}
+
+void
+NVMem_storeData(uint32_t to, uint32_t nBytes, const uint8_t *from)
+{
+    TEST_ASSERT_TRUE((to + nBytes) <= sizeof(nvImage));
+    memcpy(&nvImage[to], from, nBytes);
+    ++nStores;
+}
+
+void
+setUp(void)
+{
+    uint32_t i;
+
+    memset(nvImage, 0, sizeof(nvImage));
+    for (i = 0; i < sizeof(values); ++i)
+    {
+        values[i] = (uint8_t)(i + 1);
+    }
+    nCalls = nStores = 0;
+    TEST_ASSERT_TRUE(NVMemQueue_open());
+}
+
+void
+tearDown(void)
+{
+    NVMemQueue_close();
+}
+
+void
+test_DrainFromTheIdleHook(void)
+{
+    TEST_ASSERT_TRUE(NVMem_storeDataAsync(0, 2, values, done, NULL));
+    TEST_ASSERT_TRUE(NVMem_storeDataAsync(2, 2, values, done, NULL));
+    TEST_ASSERT_EQUAL(0, nStores);
+    TEST_ASSERT_EQUAL(2, NVMemQueue_drain());
+    TEST_ASSERT_EQUAL(0, NVMemQueue_drain());
+    TEST_ASSERT_EQUAL(2, nCalls);
+    TEST_ASSERT_EQUAL_MEMORY(values, &nvImage[2], 2);
+}
+
+void
+test_SyncDrainsInOrder(void)
+{
+    int i;
+
+    for (i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_TRUE(NVMem_storeDataAsync(8, 2, &values[i * 2], done,
+                                              (void *)(intptr_t)i));
+    }
+    NVMem_sync();
+    TEST_ASSERT_EQUAL(3, nStores);
+    TEST_ASSERT_EQUAL(0, order[0]);
+    TEST_ASSERT_EQUAL(1, order[1]);
+    TEST_ASSERT_EQUAL(2, order[2]);
+    TEST_ASSERT_EQUAL_MEMORY(&values[4], &nvImage[8], 2);
+    TEST_ASSERT_EQUAL(0, NVMemQueue_drain());
+}
+
+void
+test_RejectWhenFullUntilDrained(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < NVMEM_QUEUE_SIZE; ++i)
+    {
+        TEST_ASSERT_TRUE(NVMem_storeDataAsync(i, 1, &values[i],
+                                              (NVMemStoreDone)0, NULL));
+    }
+    TEST_ASSERT_FALSE(NVMem_storeDataAsync(i, 1, &values[i],
+                                           (NVMemStoreDone)0, NULL));
+    TEST_ASSERT_EQUAL(NVMEM_QUEUE_SIZE, NVMemQueue_drain());
+    TEST_ASSERT_TRUE(NVMem_storeDataAsync(i, 1, &values[i],
+                                           (NVMemStoreDone)0, NULL));
+    NVMem_sync();
+    TEST_ASSERT_EQUAL_MEMORY(values, nvImage, i + 1);
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,220 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_sched.c
+ *  \brief  Unit test for the request scheduler of the NVMem clients.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  The requests are done on top of NVMem_sim.c, whose simulated time is
+ *  the clock of the scheduler, so that latencies are those of the
+ *  default timing of NVMem_sim.h.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "NVMem_sched.h"
+#include "NVMem_part.h"
+#include "NVMem_sim.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define CONFIG              NVMEM_SCHED_ID(CONFIG)
+#define FFILE               NVMEM_SCHED_ID(FFILE)
+#define GSTATUS             NVMEM_SCHED_ID(GSTATUS)
+#define NONE                NVMEM_SCHED_NO_DEADLINE
+#define BULK_LEN            (8 * 1024)
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemSchedStats stats;
+static uint8_t block[BULK_LEN];
+static uint8_t ram[BULK_LEN];
+static int order[NVMEM_SCHED_NUM_CLIENTS * NVMEM_SCHED_DEPTH];
+static int nCalls;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+done(void *ctx)
+{
+    order[nCalls++] = (int)(intptr_t)ctx;
+}
+
+static void
+dispatchAll(void)
+{
+    while (NVMemSched_dispatch())
+    {
+    }
+}
+
+static void
+report(const char *what, NVMemSchedClient client)
+{
+    NVMemSched_getStats(client, &stats);
+    printf("%-12s %u requests, max depth %u, latency avg %.3f ms, "
+           "max %.3f ms\n",
+           what, stats.nDone, stats.maxDepth,
+           (stats.nDone != 0) ? stats.totalLatency / 1e3 / stats.nDone : 0.0,
+           stats.maxLatency / 1e3);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+uint32_t
+NVMemSched_now(void)
+{
+    return (uint32_t)(NVMemSim_now() / 1000);
+}
+
+void
+setUp(void)
+{
+    NVMemSimCfg cfg = NVMEM_SIM_DFT_CFG;
+    size_t i;
+
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    NVMemSched_open();
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        block[i] = (uint8_t)(i * 7);
+    }
+    nCalls = 0;
+}
+
+void
+tearDown(void)
+{
+    NVMemSim_close();
+}
+
+void
+test_PreemptABulkStoreForAConfigSave(void)
+{
+    TEST_ASSERT_TRUE(NVMemSched_store(FFILE, 0, BULK_LEN, block, NONE,
+                                      done, (void *)(intptr_t)FFILE));
+    TEST_ASSERT_TRUE(NVMemSched_dispatch());
+    TEST_ASSERT_TRUE(NVMemSched_store(CONFIG, BULK_LEN, 64, block, NONE,
+                                      done, (void *)(intptr_t)CONFIG));
+    dispatchAll();
+
+    TEST_ASSERT_EQUAL(2, nCalls);
+    TEST_ASSERT_EQUAL(CONFIG, order[0]);
+    TEST_ASSERT_EQUAL(FFILE, order[1]);
+    NVMem_readData(0, BULK_LEN, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, BULK_LEN);
+
+    report("config", CONFIG);
+    report("ffile", FFILE);
+    NVMemSched_getStats(CONFIG, &stats);
+    TEST_ASSERT_TRUE(stats.maxLatency < 1000);
+}
+
+void
+test_ServeDueDeadlinesFirst(void)
+{
+    TEST_ASSERT_TRUE(NVMemSched_store(CONFIG, 0, 1024, block, NONE,
+                                      done, (void *)(intptr_t)CONFIG));
+    TEST_ASSERT_TRUE(NVMemSched_store(GSTATUS, 4096, 64, block,
+                                      NVMEM_SCHED_SLACK, done,
+                                      (void *)(intptr_t)GSTATUS));
+    TEST_ASSERT_TRUE(NVMemSched_store(FFILE, 8192, 64, block,
+                                      NVMEM_SCHED_SLACK * 100, done,
+                                      (void *)(intptr_t)FFILE));
+    dispatchAll();
+
+    TEST_ASSERT_EQUAL(GSTATUS, order[0]);
+    TEST_ASSERT_EQUAL(CONFIG, order[1]);
+    TEST_ASSERT_EQUAL(FFILE, order[2]);
+    NVMemSched_getStats(GSTATUS, &stats);
+    TEST_ASSERT_EQUAL(0, stats.nMissed);
+}
+
+void
+test_ServeClientsOverBudgetLast(void)
+{
+    NVMemSched_setClass(FFILE, NVMEM_SCHED_BULK, 1024);
+    NVMemSched_setClass(GSTATUS, NVMEM_SCHED_BULK, 0);
+    TEST_ASSERT_TRUE(NVMemSched_store(FFILE, 0, BULK_LEN, block, NONE,
+                                      done, (void *)(intptr_t)FFILE));
+    TEST_ASSERT_TRUE(NVMemSched_store(GSTATUS, BULK_LEN, BULK_LEN, block,
+                                      NONE, done,
+                                      (void *)(intptr_t)GSTATUS));
+    dispatchAll();
+
+    TEST_ASSERT_EQUAL(GSTATUS, order[0]);
+    TEST_ASSERT_EQUAL(FFILE, order[1]);
+}
+
+void
+test_EraseEachSectorOnceWhenOverwriting(void)
+{
+    NVMemSimStats simStats;
+    size_t i;
+
+    NVMem_storeData(100, BULK_LEN, block);
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        ram[i] = (uint8_t)~block[i];
+    }
+    NVMemSim_resetStats();
+    TEST_ASSERT_TRUE(NVMemSched_store(FFILE, 100, BULK_LEN, ram, NONE,
+                                      done, (void *)(intptr_t)FFILE));
+    dispatchAll();
+
+    TEST_ASSERT_EQUAL(1, nCalls);
+    NVMemSim_getStats(&simStats);
+    TEST_ASSERT_EQUAL((100 + BULK_LEN) / NVMEM_SECTOR_SIZE + 1,
+                      simStats.nErases);
+    NVMem_readData(100, BULK_LEN, block);
+    TEST_ASSERT_EQUAL_MEMORY(ram, block, BULK_LEN);
+}
+
+void
+test_ReportQueueDepthAndLatency(void)
+{
+    int i;
+
+    for (i = 0; i < NVMEM_SCHED_DEPTH; ++i)
+    {
+        TEST_ASSERT_TRUE(NVMemSched_read(GSTATUS, (uint32_t)i * 256, 256,
+                                         &ram[i * 256], NONE, done,
+                                         (void *)(intptr_t)GSTATUS));
+    }
+    TEST_ASSERT_FALSE(NVMemSched_read(GSTATUS, 0, 1, ram, NONE, done,
+                                      NULL));
+    NVMemSched_getStats(GSTATUS, &stats);
+    TEST_ASSERT_EQUAL(NVMEM_SCHED_DEPTH, stats.depth);
+
+    dispatchAll();
+    report("gstatus", GSTATUS);
+    NVMemSched_getStats(GSTATUS, &stats);
+    TEST_ASSERT_EQUAL(0, stats.depth);
+    TEST_ASSERT_EQUAL(NVMEM_SCHED_DEPTH, stats.maxDepth);
+    TEST_ASSERT_EQUAL(NVMEM_SCHED_DEPTH, stats.nDone);
+    TEST_ASSERT_EQUAL(NVMEM_SCHED_DEPTH * 256, stats.bytes);
+    TEST_ASSERT_TRUE(stats.maxLatency >= stats.totalLatency /
+                                         NVMEM_SCHED_DEPTH);
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,185 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_sim.c
+ *  \brief  Unit test for the simulated flash NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/* ----------------------------- Include files ----------------------------- */
+#include <string.h>
+#include "unity.h"
+#include "NVMem_sim.h"
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define PAGE_SIZE           256
+#define SECTOR_SIZE         4096
+#define READ_NS             5000
+#define PROGRAM_NS          700000
+#define ERASE_NS            45000000
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemSimCfg cfg;
+static NVMemSimStats stats;
+static uint8_t block[600];
+static uint8_t ram[600];
+static uint8_t erased[600];
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+fillBlock(uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        block[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    NVMemSimCfg dftCfg = NVMEM_SIM_DFT_CFG;
+
+    cfg = dftCfg;
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    fillBlock(0x51);
+    memset(erased, NVMEM_SIM_ERASED_VALUE, sizeof(erased));
+}
+
+void
+tearDown(void)
+{
+    NVMemSim_close();
+}
+
+void
+test_RejectWrongGeometry(void)
+{
+    cfg.sectorSize = 1000;
+    TEST_ASSERT_FALSE(NVMemSim_open(&cfg));
+    cfg.sectorSize = SECTOR_SIZE;
+    cfg.size = SECTOR_SIZE * 3 + 1;
+    TEST_ASSERT_FALSE(NVMemSim_open(&cfg));
+}
+
+void
+test_ReadPagesOfAnErasedPart(void)
+{
+    NVMem_readData(200, 300, ram);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram, 300);
+    NVMemSim_getStats(&stats);
+    TEST_ASSERT_EQUAL(300, stats.bytesRead);
+    TEST_ASSERT_EQUAL(2, stats.nReads);
+    TEST_ASSERT_EQUAL(2 * READ_NS, NVMemSim_now());
+}
+
+void
+test_ProgramErasedPagesWithoutErasing(void)
+{
+    NVMem_storeData(250, 16, block);
+    NVMem_readData(250, 16, ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, 16);
+
+    NVMemSim_getStats(&stats);
+    TEST_ASSERT_EQUAL(16, stats.bytesStored);
+    TEST_ASSERT_EQUAL(2, stats.nPrograms);
+    TEST_ASSERT_EQUAL(2 * PAGE_SIZE, stats.bytesProgrammed);
+    TEST_ASSERT_EQUAL(0, stats.nErases);
+    TEST_ASSERT_EQUAL(0, NVMemSim_eraseCount(0));
+}
+
+void
+test_EraseAndMergeTheSectorToSetBits(void)
+{
+    NVMem_storeData(1024, sizeof(block), block);
+    fillBlock(0x52);
+    NVMem_storeData(16, 32, block);
+    NVMem_storeData(16, 32, erased);
+    NVMemSim_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.nErases);
+    TEST_ASSERT_EQUAL(1, NVMemSim_eraseCount(0));
+    TEST_ASSERT_EQUAL(0, stats.nViolations);
+
+    NVMem_readData(16, 32, ram);
+    TEST_ASSERT_EQUAL_MEMORY(erased, ram, 32);
+    fillBlock(0x51);
+    NVMem_readData(1024, sizeof(block), ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, sizeof(block));
+}
+
+void
+test_CountWriteAmplificationAndTime(void)
+{
+    NVMem_storeData(0, 16, block);
+    NVMem_storeData(PAGE_SIZE, 16, block);
+    NVMemSim_resetStats();
+    fillBlock(0x53);
+    NVMem_storeData(0, 16, block);
+    NVMemSim_getStats(&stats);
+
+    /* erase, then program back the two pages in use */
+    TEST_ASSERT_EQUAL(1, stats.nErases);
+    TEST_ASSERT_EQUAL(2, stats.nPrograms);
+    TEST_ASSERT_EQUAL(32, stats.bytesProgrammed / stats.bytesStored);
+    TEST_ASSERT_EQUAL((4 * (uint64_t)PROGRAM_NS) + ERASE_NS, 
+                      NVMemSim_now());
+}
+
+void
+test_StoreAcrossSectors(void)
+{
+    NVMem_storeData(SECTOR_SIZE - 100, sizeof(block), block);
+    NVMem_storeData(SECTOR_SIZE - 100, sizeof(block), erased);
+    NVMemSim_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, NVMemSim_eraseCount(0));
+    TEST_ASSERT_EQUAL(1, NVMemSim_eraseCount(1));
+    TEST_ASSERT_EQUAL(0, NVMemSim_eraseCount(2));
+    TEST_ASSERT_EQUAL(2, stats.nErases);
+    TEST_ASSERT_EQUAL(1, stats.maxEraseCount);
+}
+
+void
+test_KeepCellsWhenStrict(void)
+{
+    cfg.strict = true;
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    ram[0] = 0x0f;
+    NVMem_storeData(8, 1, ram);
+    ram[0] = 0xf0;
+    NVMem_storeData(8, 1, ram);
+    NVMem_readData(8, 1, ram);
+    TEST_ASSERT_EQUAL_HEX8(0x00, ram[0]);
+    NVMemSim_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.nViolations);
+    TEST_ASSERT_EQUAL(0, stats.nErases);
+
+    TEST_ASSERT_TRUE(NVMemSim_erase(8));
+    TEST_ASSERT_FALSE(NVMemSim_erase(cfg.size));
+    ram[0] = 0xf0;
+    NVMem_storeData(8, 1, ram);
+    NVMem_readData(8, 1, ram);
+    TEST_ASSERT_EQUAL_HEX8(0xf0, ram[0]);
+    TEST_ASSERT_EQUAL(1, NVMemSim_eraseCount(0));
+}
+
+/* ------------------------------ End of file ------------------------------ */
@@ -0,0 +1,240 @@
+/*
+ *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------
+ */
+
+/**
+ *  \file   test_NVMem_wear.c
+ *  \brief  Unit test for the wear-leveling layer of NVMem.
+ */
+
+/* -------------------------- Development history -------------------------- */
+/*
+ */
+
+/* -------------------------------- Authors -------------------------------- */
+/*
+ *  LeFr  Leandro Francucci     lf@vortexmakes.com
+ */
+
+/* --------------------------------- Notes --------------------------------- */
+/*
+ *  It is built with NVMEM_WEAR, so the simulated flash provides the
+ *  device entry points. The stores of Config.recovery, the main and the
+ *  backup copies in turn, are replayed in place and through the layer.
+ *  The write amplification, relative to the bytes Config stores, and
+ *  the projected lifetime of the part, until its most worn sector
+ *  reaches ENDURANCE erases, are printed.
+ */
+
+/* ----------------------------- Include files ----------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "NVMem_wear.h"
+#include "NVMem_sim.h"
+
+TEST_FILE("NVmem.c")
+TEST_FILE("Crc32_sw.c")
+TEST_FILE("Crc32_clmul.c")
+
+/* ----------------------------- Local macros ------------------------------ */
+/* ------------------------------- Constants ------------------------------- */
+#define SECTOR              NVMEM_SECTOR_SIZE
+#define ENDURANCE           100000
+#define NUM_UPDATES         2000
+#define BLOCK_LEN           64
+
+/* ---------------------------- Local data types --------------------------- */
+/* ---------------------------- Global variables --------------------------- */
+/* ---------------------------- Local variables ---------------------------- */
+static NVMemWearStats stats;
+static NVMemSimStats simStats;
+static uint8_t block[BLOCK_LEN];
+static uint8_t ram[2 * BLOCK_LEN];
+static uint32_t seed;
+
+/* ----------------------- Local function prototypes ----------------------- */
+/* ---------------------------- Local functions ---------------------------- */
+static void
+fillBlock(void)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(block); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        block[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void
+replayConfig(void (*store)(uint32_t to, uint32_t nBytes,
+                           const uint8_t *from))
+{
+    uint32_t i;
+
+    NVMemSim_resetStats();
+    for (i = 0; i < NUM_UPDATES; ++i)
+    {
+        fillBlock();
+        store(NVMEM_PART_ADDR(CONFIG_MAIN), BLOCK_LEN, block);
+        store(NVMEM_PART_ADDR(CONFIG_BACKUP), BLOCK_LEN, block);
+    }
+    NVMemSim_getStats(&simStats);
+}
+
+static void
+report(const char *what)
+{
+    printf("%-12s max %u erases per sector, write amplification %.1f, "
+           "lifetime %.0f updates\n",
+           what, simStats.maxEraseCount,
+           (double)simStats.bytesProgrammed / (2 * NUM_UPDATES * BLOCK_LEN),
+           (double)ENDURANCE * NUM_UPDATES / simStats.maxEraseCount);
+}
+
+/* ---------------------------- Global functions --------------------------- */
+void
+setUp(void)
+{
+    NVMemSimCfg cfg = NVMEM_SIM_DFT_CFG;
+
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    TEST_ASSERT_TRUE(NVMemWear_open());
+    NVMemWear_resetStats();
+    seed = 0x3ea5;
+    fillBlock();
+}
+
+void
+tearDown(void)
+{
+    NVMemSim_close();
+}
+
+void
+test_ReadBackAcrossBlocks(void)
+{
+    NVMem_storeData(SECTOR - BLOCK_LEN, sizeof(block), block);
+    NVMem_storeData(SECTOR, sizeof(block), block);
+    TEST_ASSERT_TRUE(NVMemWear_open());
+
+    NVMem_readData(SECTOR - BLOCK_LEN, sizeof(ram), ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, BLOCK_LEN);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram + BLOCK_LEN, BLOCK_LEN);
+    NVMemWear_getStats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.nRelocations);
+}
+
+void
+test_RelocateWhenAStoreNeedsAnErase(void)
+{
+    uint8_t first[BLOCK_LEN];
+
+    memcpy(first, block, sizeof(first));
+    NVMem_storeData(0, sizeof(first), first);
+    fillBlock();
+    NVMem_storeData(BLOCK_LEN, sizeof(block), block);
+    NVMem_storeData(BLOCK_LEN, sizeof(block), first);
+
+    NVMemWear_getStats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.nRelocations);
+    TEST_ASSERT_EQUAL(1, NVMemWear_eraseCount(0));
+    NVMemSim_getStats(&simStats);
+    TEST_ASSERT_EQUAL(0, simStats.nViolations);
+
+    TEST_ASSERT_TRUE(NVMemWear_open());
+    TEST_ASSERT_EQUAL(1, NVMemWear_eraseCount(0));
+    NVMem_readData(0, sizeof(ram), ram);
+    TEST_ASSERT_EQUAL_MEMORY(first, ram, BLOCK_LEN);
+    TEST_ASSERT_EQUAL_MEMORY(first, ram + BLOCK_LEN, BLOCK_LEN);
+}
+
+void
+test_MigrateColdBlocks(void)
+{
+    uint32_t i, sector, least, most;
+
+    NVMem_storeData(SECTOR, sizeof(block), block);
+    for (i = 0; i < NUM_UPDATES; ++i)
+    {
+        fillBlock();
+        NVMem_storeData(0, sizeof(block), block);
+    }
+    NVMemWear_getStats(&stats);
+    TEST_ASSERT_TRUE(stats.nMigrations > 0);
+
+    least = most = NVMemWear_eraseCount(0);
+    for (sector = 1; sector < NVMEM_WEAR_SECTORS; ++sector)
+    {
+        least = (NVMemWear_eraseCount(sector) < least) ?
+                NVMemWear_eraseCount(sector) : least;
+        most = (NVMemWear_eraseCount(sector) > most) ?
+               NVMemWear_eraseCount(sector) : most;
+    }
+    TEST_ASSERT_TRUE((most - least) <= (2 * NVMEM_WEAR_DELTA));
+
+    TEST_ASSERT_TRUE(NVMemWear_open());
+    NVMem_readData(0, sizeof(ram), ram);
+    TEST_ASSERT_EQUAL_MEMORY(block, ram, BLOCK_LEN);
+}
+
+void
+test_PersistTheErasesDoneAtOpen(void)
+{
+    uint32_t sector;
+
+    sector = NVMEM_WEAR_SECTORS - 1;
+    NVMemDev_storeData(NVMEM_WEAR_BASE + ((sector + 2) * SECTOR),
+                       sizeof(block), block);
+    TEST_ASSERT_TRUE(NVMemWear_open());
+    TEST_ASSERT_EQUAL(1, NVMemWear_eraseCount(sector));
+
+    TEST_ASSERT_TRUE(NVMemWear_open());
+    TEST_ASSERT_EQUAL(1, NVMemWear_eraseCount(sector));
+}
+
+void
+test_CountOnlyTheErasesDone(void)
+{
+    uint32_t i, sector, counted, erased;
+
+    for (i = 0; i < NUM_UPDATES; ++i)
+    {
+        fillBlock();
+        NVMem_storeData(0, sizeof(block), block);
+    }
+    NVMemWear_getStats(&stats);
+    TEST_ASSERT_TRUE(stats.nMigrations > 0);
+
+    for (sector = 0, counted = erased = 0; sector < NVMEM_WEAR_SECTORS;
+         ++sector)
+    {
+        counted += NVMemWear_eraseCount(sector);
+        erased += NVMemSim_eraseCount((NVMEM_WEAR_BASE / SECTOR) + 2 +
+                                      sector);
+    }
+    TEST_ASSERT_EQUAL(erased, counted);
+}
+
+void
+test_ReportLifetime(void)
+{
+    NVMemSimCfg cfg = NVMEM_SIM_DFT_CFG;
+    uint32_t inPlace;
+
+    replayConfig(NVMemDev_storeData);
+    report("in place");
+    inPlace = simStats.maxEraseCount;
+
+    TEST_ASSERT_TRUE(NVMemSim_open(&cfg));
+    TEST_ASSERT_TRUE(NVMemWear_open());
+    replayConfig(NVMem_storeData);
+    report("wear-level");
+    TEST_ASSERT_TRUE((simStats.maxEraseCount * 4) < inPlace);
+    NVMemSim_getStats(&simStats);
+    TEST_ASSERT_EQUAL(0, simStats.nViolations);
+}
+
+/* ------------------------------ End of file ------------------------------ */